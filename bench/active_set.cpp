@@ -0,0 +1,102 @@
+#include "neuron_sim.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+// 活跃集合跟踪：不同活跃程度下更新阶段的耗时（跟踪 / 逐个更新全部神经元），
+// 对照活跃集合（膜动力学未静息）的平均大小；整步耗时被 O(N^2) 的连接检查主导，只作参考。
+// 最后与逐个更新的结果对比（相同种子运行相同步数后逐个比较神经元状态和突触，要求完全相同）。
+// 活跃程度由连接距离阈值（决定每个神经元带着多少突触）和随机激活概率控制，
+// 250 是数字识别训练使用的阈值（DIGIT_THRESHOLD）。
+// 用法: active_set [神经元数] [步数]
+
+static NeuralNetworkSimulation make_sim(int numNeurons, double threshold, double chance, bool tracking) {
+    SimulationParams params;
+    params.connectionThreshold = threshold;
+    params.activationChance = chance;
+    params.seed = 42;
+    params.trackActiveSet = tracking;
+    return NeuralNetworkSimulation(numNeurons, 1000, 800, params);
+}
+
+struct RunResult {
+    double stepMs;            // 每步总耗时
+    double updateMs;          // 每步更新阶段耗时
+    double activeFraction;    // 活跃集合的平均比例
+};
+
+// 每隔一段时间刺激一部分神经元，模拟训练时的外部输入
+static RunResult run(NeuralNetworkSimulation& sim, int steps) {
+    RunResult result{0, 0, 0};
+    sim.updateSeconds = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        if (i % 50 == 0) {
+            for (size_t id = 0; id < sim.neurons.size(); id += 16) sim.stimulate(static_cast<int>(id));
+        }
+        sim.step();
+        result.activeFraction += static_cast<double>(sim.getActiveCount()) / sim.neurons.size();
+    }
+    result.stepMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / steps;
+    result.updateMs = sim.updateSeconds * 1000.0 / steps;
+    result.activeFraction /= steps;
+    return result;
+}
+
+// 两个网络的状态是否完全一致（包括按闭式补算到当前步的突触强度）
+static bool same_state(const NeuralNetworkSimulation& a, const NeuralNetworkSimulation& b, std::string& why) {
+    for (size_t id = 0; id < a.neurons.size(); ++id) {
+        NeuronState sa = a.neuronById(id).getState(), sb = b.neuronById(id).getState();
+        if (sa.position.x != sb.position.x || sa.position.y != sb.position.y || sa.potential != sb.potential ||
+            sa.isFiring != sb.isFiring || sa.lastFired != sb.lastFired || sa.activationLevel != sb.activationLevel) {
+            why = "神经元 " + std::to_string(id) + " 状态不同";
+            return false;
+        }
+        auto synA = a.neuronById(id).getActiveSynapses(), synB = b.neuronById(id).getActiveSynapses();
+        if (synA.size() != synB.size()) {
+            why = "神经元 " + std::to_string(id) + " 活跃突触数不同";
+            return false;
+        }
+        for (size_t k = 0; k < synA.size(); ++k) {
+            if (a.idOf(synA[k].targetNeuron) != b.idOf(synB[k].targetNeuron) || synA[k].strength != synB[k].strength ||
+                synA[k].lastUsed != synB[k].lastUsed) {
+                why = "神经元 " + std::to_string(id) + " 的突触不同";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int numNeurons = argc > 1 ? std::stoi(argv[1]) : 1000;
+    int steps = argc > 2 ? std::stoi(argv[2]) : 600;   // 超过 reorderInterval，覆盖重排后的集合重映射
+
+    std::cout << "神经元: " << numNeurons << "  步数: " << steps << std::endl;
+    std::cout << std::setw(10) << "连接阈值" << std::setw(10) << "随机激活" << std::setw(10) << "活跃集合"
+              << std::setw(12) << "更新全部" << std::setw(12) << "更新跟踪"
+              << std::setw(10) << "加速比" << std::setw(12) << "整步加速比" << "  结果" << std::endl;
+    std::cout << "（活跃集合为占全部神经元的平均比例，更新耗时单位为 ms/步）" << std::endl;
+
+    bool allSame = true;
+    for (double threshold : {0.0, 10.0, 30.0, 90.0, 250.0}) {
+        for (double chance : {0.0, 0.001, 0.05}) {
+            NeuralNetworkSimulation full = make_sim(numNeurons, threshold, chance, false);
+            NeuralNetworkSimulation tracked = make_sim(numNeurons, threshold, chance, true);
+            RunResult fullRun = run(full, steps);
+            RunResult trackedRun = run(tracked, steps);
+
+            std::string why;
+            bool same = same_state(full, tracked, why);
+            allSame = allSame && same;
+            std::cout << std::setw(10) << threshold << std::setw(10) << chance << std::fixed
+                      << std::setw(10) << std::setprecision(3) << trackedRun.activeFraction
+                      << std::setw(12) << fullRun.updateMs << std::setw(12) << trackedRun.updateMs
+                      << std::setw(10) << std::setprecision(2) << fullRun.updateMs / trackedRun.updateMs
+                      << std::setw(12) << fullRun.stepMs / trackedRun.stepMs << std::defaultfloat << std::setprecision(6)
+                      << "  " << (same ? "一致" : why) << std::endl;
+        }
+    }
+    return allSame ? 0 : 1;
+}
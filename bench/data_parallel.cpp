@@ -0,0 +1,80 @@
+#include "neuron_sim.h"
+#include "img_char_number.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <filesystem>
+#include <unistd.h>
+
+// 数据并行训练的加速比和准确率：先用 train_on_image 顺序训练一遍作为基准，
+// 再用 K 个副本（K = 1..最大K）训练同一批图片，加速比相对顺序训练计算。
+// K=1 仍走并行路径（每张图片后合并/分发一次），与顺序训练的差别即合并本身的开销。
+// 模型按 recognize 的方式（保存后载入新网络）在留出集上评估。需要在仓库根目录运行。
+// 用法: data_parallel [每个数字的训练图片数] [每个数字的测试图片数] [每张图片的训练步数] [avg|max] [最大K]
+
+namespace fs = std::filesystem;
+
+static double evaluate(const NeuralNetworkSimulation& trained, const std::vector<DigitImage>& evalSet) {
+    std::string path = (fs::temp_directory_path() / ("neuron_data_parallel_" + std::to_string(getpid()) + ".bin")).string();
+    NeuralNetworkSimulation model(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, trained.params);
+    bool ok = save_training_result(trained, path) && load_training_result(model, path);
+    fs::remove(path);
+    if (!ok) return 0.0;
+
+    int correct = 0;
+    for (const auto& sample : evalSet) {
+        NeuralNetworkSimulation copy = model;
+        if (recognize_digit(copy, sample.img) == sample.digit) correct++;
+    }
+    return evalSet.empty() ? 0.0 : static_cast<double>(correct) / evalSet.size();
+}
+
+int main(int argc, char* argv[]) {
+    size_t trainPerDigit = argc > 1 ? std::stoul(argv[1]) : 4;
+    size_t evalPerDigit = argc > 2 ? std::stoul(argv[2]) : 3;
+    SimulationParams params;
+    params.connectionThreshold = DIGIT_THRESHOLD;
+    params.trainSteps = argc > 3 ? std::stoi(argv[3]) : 200;
+    SynapseMergeMode mode = argc > 4 && std::string(argv[4]) == "max" ? SynapseMergeMode::MAX : SynapseMergeMode::AVERAGE;
+    int maxReplicas = argc > 5 ? std::stoi(argv[5]) : 16;
+
+    std::vector<DigitSample> trainFiles, holdoutFiles;
+    split_digit_samples(list_digit_samples(DIGIT_TRAIN_DIR), trainFiles, holdoutFiles);
+    std::vector<DigitImage> trainSet = load_digit_images(trainFiles, trainPerDigit);
+    std::vector<DigitImage> evalSet = load_digit_images(holdoutFiles, evalPerDigit);
+    if (trainSet.empty() || evalSet.empty()) {
+        std::cerr << "训练集或测试集为空: " << DIGIT_TRAIN_DIR << std::endl;
+        return 1;
+    }
+
+    std::cout << "训练/测试图片: " << trainSet.size() << "/" << evalSet.size()
+              << "  每张步数: " << params.trainSteps << "  合并: " << (mode == SynapseMergeMode::MAX ? "max" : "avg")
+              << "  硬件线程: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::setw(6) << "K" << std::setw(12) << "耗时(s)" << std::setw(10) << "加速比"
+              << std::setw(10) << "准确率" << std::setw(12) << "突触数" << std::endl;
+
+    NeuralNetworkSimulation sequential(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, params);
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& image : trainSet) train_on_image(sequential, image.img, image.digit);
+    const double baseline = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::setw(6) << "顺序" << std::setw(12) << std::fixed << std::setprecision(2) << baseline
+              << std::setw(10) << 1.0
+              << std::setw(10) << std::setprecision(3) << evaluate(sequential, evalSet)
+              << std::setw(12) << sequential.getTotalSynapses() << std::endl;
+
+    for (int k = 1; k <= maxReplicas; ++k) {
+        NeuralNetworkSimulation master(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, params);
+        start = std::chrono::steady_clock::now();
+        // 每个副本每张图片合并一次
+        train_data_parallel(master, trainSet, k, 1, mode);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::setw(6) << k << std::setw(12) << std::fixed << std::setprecision(2) << seconds
+                  << std::setw(10) << baseline / seconds
+                  << std::setw(10) << std::setprecision(3) << evaluate(master, evalSet)
+                  << std::setw(12) << master.getTotalSynapses() << std::endl;
+    }
+    return 0;
+}
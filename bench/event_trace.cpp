@@ -0,0 +1,54 @@
+#include "neuron_sim.h"
+#include "event_trace.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <filesystem>
+
+// 事件追踪对 step() 的开销：同一初始状态分别不追踪 / 追踪全部事件运行相同步数
+// 用法: event_trace [神经元数] [步数]
+
+namespace fs = std::filesystem;
+
+static double run_steps(NeuralNetworkSimulation sim, int steps, TraceRecorder* trace) {
+    sim.trace = trace;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) sim.step();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / steps;
+}
+
+int main(int argc, char* argv[]) {
+    int numNeurons = argc > 1 ? std::stoi(argv[1]) : 794;
+    int steps = argc > 2 ? std::stoi(argv[2]) : 500;
+
+    NeuralNetworkSimulation sim(numNeurons, 1000, 800, 250);
+    for (int i = 0; i < 100; ++i) sim.step();
+    std::cout << "神经元: " << numNeurons << "  突触: " << sim.getTotalSynapses() << "  步数: " << steps << std::endl;
+
+    fs::path path = fs::temp_directory_path() / "neuron_event_trace_bench.trc";
+    double plain = 0, traced = 0;
+    uint64_t events = 0, dropped = 0, bytes = 0;
+    // 交替运行两次取平均，减少频率和缓存状态的影响
+    for (int round = 0; round < 2; ++round) {
+        plain += run_steps(sim, steps, nullptr) / 2;
+        TraceRecorder recorder(path.string());
+        if (!recorder.start()) return 1;
+        traced += run_steps(sim, steps, &recorder) / 2;
+        recorder.stop();
+        events += recorder.getWritten();
+        dropped += recorder.getDropped();
+        bytes += recorder.getBytes();
+    }
+    fs::remove(path);
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "不追踪: " << plain << " ms/步" << std::endl
+              << "追踪:   " << traced << " ms/步  开销 " << std::setprecision(1)
+              << 100.0 * (traced - plain) / plain << "%" << std::endl
+              << "事件: " << std::setprecision(0) << static_cast<double>(events) / (2 * steps) << " 个/步  "
+              << std::setprecision(2) << static_cast<double>(bytes) / std::max<uint64_t>(1, events) << " 字节/事件  "
+              << "丢弃: " << dropped << std::endl;
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "neuron_sim.h"
+#include "frame_export.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <filesystem>
+#include <thread>
+
+// 离屏录制对模拟循环的开销：不录制 vs 每k步录一帧PNG（后台线程渲染+压缩）。
+// 除整体步速外，分开报告模拟线程上的直接开销（复制快照的平均耗时和单次 onStep 的最长停顿）：
+// 只有一个CPU核时编码线程与模拟分时运行，步速下降主要来自编码本身，而不是模拟线程在等待。
+// 表头打印CPU核数和 cairo 版本，贴出结果时一并注明
+// 用法: frame_export [神经元数] [步数]
+
+namespace fs = std::filesystem;
+
+static double run_steps(NeuralNetworkSimulation sim, int steps, FrameExporter* recorder) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        sim.step();
+        if (recorder) recorder->onStep(sim);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    const int WIDTH = 1000, HEIGHT = 800;
+    int numNeurons = argc > 1 ? std::stoi(argv[1]) : 794;
+    int steps = argc > 2 ? std::stoi(argv[2]) : 2000;
+
+    // 与 img_char_number 相同的规模和连接阈值，先运行一段时间建立突触
+    NeuralNetworkSimulation sim(numNeurons, WIDTH, HEIGHT, 250);
+    for (int i = 0; i < 200; ++i) sim.step();
+    std::cout << "神经元: " << numNeurons << "  突触: " << sim.getTotalSynapses() << "  步数: " << steps
+              << "  CPU核: " << std::thread::hardware_concurrency() << "  cairo " << cairo_version_string() << std::endl;
+
+    double baseline = run_steps(sim, steps, nullptr);
+    std::cout << std::setw(8) << "每k步" << std::setw(12) << "步/秒" << std::setw(10) << "开销"
+              << std::setw(10) << "写出" << std::setw(10) << "丢弃" << std::setw(14) << "复制(ms/帧)"
+              << std::setw(14) << "最长停顿(ms)" << std::setw(14) << "编码(ms/帧)" << std::endl;
+    std::cout << std::setw(8) << "-" << std::setw(12) << std::fixed << std::setprecision(0) << steps / baseline
+              << std::setw(10) << "-" << std::endl;
+
+    fs::path dir = fs::temp_directory_path() / "neuron_frame_export_bench";
+    for (int every : {100, 10, 1}) {
+        fs::remove_all(dir);
+        FrameExporter recorder(FrameOutput::PNG_SEQUENCE, dir.string(), WIDTH, HEIGHT, every);
+        if (!recorder.start()) return 1;
+        double seconds = run_steps(sim, steps, &recorder);
+        recorder.finish();
+        FrameExportStats stats = recorder.getStats();
+        long frames = std::max(1L, stats.captured);
+
+        std::cout << std::setw(8) << every << std::setw(12) << std::setprecision(0) << steps / seconds
+                  << std::setw(9) << std::setprecision(1) << 100.0 * (seconds - baseline) / baseline << "%"
+                  << std::setw(10) << stats.written << std::setw(10) << stats.dropped
+                  << std::setw(14) << std::setprecision(3) << stats.captureMs / frames << std::setw(14) << stats.maxStallMs
+                  << std::setw(14) << stats.encodeMs / frames << std::endl;
+    }
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "img_char_number.h"
+#include "glyph_generator.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// 合成样本的生成速度：GlyphGenerator 生成增强后的 28x28 样本 与 从磁盘读取PNG并缩放（load_png_image）对比。
+// 需要在仓库根目录运行（PNG对比读取 DIGIT_TRAIN_DIR）。
+// 用法: glyph_generator [样本数] [字体目录]
+
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 20000;
+    std::vector<std::string> fonts = argc > 2 ? list_font_files({argv[2]}) : list_font_files();
+
+    auto buildStart = Clock::now();
+    GlyphGenerator generator(fonts, 1);
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - buildStart).count();
+    if (generator.getFontCount() == 0) {
+        std::cerr << "没有可用的字体" << std::endl;
+        return 1;
+    }
+
+    // 生成：复用同一块存储，统计墨迹像素防止被优化掉
+    std::vector<std::vector<double>> img;
+    double ink = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        generator.generate(static_cast<int>(i % DIGIT_COUNT), img);
+        for (const auto& row : img) {
+            for (double v : row) ink += v > 0.5;
+        }
+    }
+    double generateSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // 读取PNG
+    std::vector<DigitSample> samples = list_digit_samples(DIGIT_TRAIN_DIR);
+    size_t decoded = 0;
+    start = Clock::now();
+    for (const auto& sample : samples) {
+        decoded += !load_png_image(sample.path, DIGIT_INPUT_WIDTH, DIGIT_INPUT_HEIGHT).empty();
+    }
+    double pngSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << "字体: " << generator.getFontCount() << "/" << fonts.size() << "  原型栅格化: " << std::fixed
+              << std::setprecision(1) << buildMs << " ms" << std::endl;
+    std::cout << "生成样本: " << count << " 张  " << std::setprecision(0) << count / generateSeconds << " 张/秒"
+              << "  平均墨迹像素: " << std::setprecision(1) << ink / count << std::endl;
+    if (decoded > 0) {
+        std::cout << "读取PNG:  " << decoded << " 张  " << std::setprecision(0) << decoded / pngSeconds << " 张/秒"
+                  << "  （生成为其 " << std::setprecision(1) << (count / generateSeconds) / (decoded / pngSeconds)
+                  << " 倍）" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "neuron_sim.h"
+#include "synapse_index.h"
+#include "render_snapshot.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+
+// 悬停拾取查询延迟：网格索引 vs 遍历全部突触
+// 画布 1000x800，突触长度不超过250（与 img_char_number 的 THRESHOLD 相同）
+
+// 原 on_mouse_motion 的做法：逐个神经元、逐条突触计算距离
+static bool linear_query(const NeuralNetworkSimulation& sim, double px, double py, double maxDistance) {
+    for (const auto& neuron : sim.neurons) {
+        const auto& pos = neuron.getPosition();
+        for (const auto& synapse : neuron.getActiveSynapses()) {
+            const auto& targetPos = sim.neurons[synapse.targetNeuron].getPosition();
+            if (point_to_segment_distance(px, py, pos.x, pos.y, targetPos.x, targetPos.y) < maxDistance) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int main() {
+    const double WIDTH = 1000, HEIGHT = 800, MAX_LENGTH = 250, HOVER = 8.0;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> xDist(0, WIDTH), yDist(0, HEIGHT);
+
+    std::cout << std::setw(10) << "突触数" << std::setw(12) << "快照(ms)" << std::setw(12) << "建索引(ms)"
+              << std::setw(14) << "网格(us/次)" << std::setw(14) << "遍历(us/次)" << std::setw(10) << "命中率" << std::endl;
+
+    for (int synapses : {10000, 100000, 1000000}) {
+        const int perNeuron = 20;
+        NeuralNetworkSimulation sim(synapses / perNeuron, WIDTH, HEIGHT, MAX_LENGTH);
+        std::uniform_int_distribution<int> pick(0, sim.neurons.size() - 1);
+        for (size_t i = 0; i < sim.neurons.size(); ++i) {
+            for (int made = 0; made < perNeuron;) {
+                int j = pick(gen);
+                if (j != static_cast<int>(i) && sim.neurons[i].isCloseEnough(sim.neurons[j], MAX_LENGTH)) {
+                    sim.neurons[i].connectTo(j, 0.5, 0);
+                    made++;
+                }
+            }
+        }
+
+        RenderSnapshot snapshot;
+        auto captureStart = std::chrono::steady_clock::now();
+        snapshot.capture(sim, false);
+        auto buildStart = std::chrono::steady_clock::now();
+        snapshot.index.build(snapshot);
+        auto buildEnd = std::chrono::steady_clock::now();
+        const SynapseIndex& index = snapshot.index;
+
+        const int queries = 20000;
+        int hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            SynapseHit hit;
+            if (index.query(xDist(gen), yDist(gen), HOVER, hit)) hits++;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        const int linearQueries = synapses >= 1000000 ? 20 : 200;
+        volatile int linearHits = 0;
+        auto linearStart = std::chrono::steady_clock::now();
+        for (int q = 0; q < linearQueries; ++q) {
+            if (linear_query(sim, xDist(gen), yDist(gen), HOVER)) linearHits = linearHits + 1;
+        }
+        auto linearEnd = std::chrono::steady_clock::now();
+
+        std::cout << std::setw(10) << index.size()
+                  << std::setw(12) << std::fixed << std::setprecision(1)
+                  << std::chrono::duration<double, std::milli>(buildStart - captureStart).count()
+                  << std::setw(12) << std::chrono::duration<double, std::milli>(buildEnd - buildStart).count()
+                  << std::setw(14) << std::setprecision(2)
+                  << std::chrono::duration<double, std::micro>(end - start).count() / queries
+                  << std::setw(14) << std::chrono::duration<double, std::micro>(linearEnd - linearStart).count() / linearQueries
+                  << std::setw(10) << std::setprecision(3) << static_cast<double>(hits) / queries << std::endl;
+    }
+    return 0;
+}
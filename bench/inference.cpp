@@ -0,0 +1,108 @@
+#include "neuron_sim.h"
+#include "img_char_number.h"
+#include "inference.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// 定点推理引擎与原实现（recognize_digit，double + 完整可塑模拟）的对比：
+// 识别结果一致率、各自的准确率和 图片/秒。原实现带随机激活，两次运行使用不同的种子，
+// 它们之间的一致率作为噪声基线。两类差别分开统计：冻结拓扑的 double 引擎与原实现之间
+// 只差被冻结的拓扑和可塑性（原实现仍会移动神经元、建立新突触），定点引擎与冻结拓扑的
+// double 引擎之间只差量化（相同种子下随机激活也相同）。需要在仓库根目录运行。
+// 用法: inference [模型文件] [每个数字的图片数]
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static std::vector<int> run_reference(const NeuralNetworkSimulation& model, const std::vector<DigitImage>& images,
+                                      double activationChance, uint64_t seed, double& seconds) {
+    std::vector<int> results;
+    auto start = Clock::now();
+    for (size_t i = 0; i < images.size(); ++i) {
+        const auto& sample = images[i];
+        NeuralNetworkSimulation copy = model;
+        copy.params.activationChance = activationChance;
+        copy.reseed(seed + i);
+        results.push_back(recognize_digit(copy, sample.img));
+    }
+    seconds = seconds_since(start);
+    return results;
+}
+
+template <typename Engine>
+static std::vector<int> run_engine(Engine& engine, const std::vector<DigitImage>& images, double& seconds) {
+    std::vector<int> results;
+    auto start = Clock::now();
+    for (const auto& sample : images) results.push_back(engine.recognize(sample.img));
+    seconds = seconds_since(start);
+    return results;
+}
+
+static double agreement(const std::vector<int>& a, const std::vector<int>& b) {
+    int same = 0;
+    for (size_t i = 0; i < a.size(); ++i) same += a[i] == b[i];
+    return a.empty() ? 0.0 : static_cast<double>(same) / a.size();
+}
+
+static double accuracy(const std::vector<int>& results, const std::vector<DigitImage>& images) {
+    int correct = 0;
+    for (size_t i = 0; i < results.size(); ++i) correct += results[i] == images[i].digit;
+    return results.empty() ? 0.0 : static_cast<double>(correct) / results.size();
+}
+
+int main(int argc, char* argv[]) {
+    std::string modelPath = argc > 1 ? argv[1] : DIGIT_MODEL_PATH;
+    size_t perDigit = argc > 2 ? std::stoul(argv[2]) : 10;
+
+    NeuralNetworkSimulation model(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, DIGIT_THRESHOLD);
+    if (!load_training_result(model, modelPath)) return 1;
+    std::vector<DigitImage> images = load_digit_images(list_digit_samples(DIGIT_TRAIN_DIR), perDigit);
+    if (images.empty()) {
+        std::cerr << "没有图片: " << DIGIT_TRAIN_DIR << std::endl;
+        return 1;
+    }
+
+    double refSeconds, refSeconds2, quietSeconds, buildSeconds, fixedSeconds, randomSeconds;
+    double frozenSeconds, frozenRandomSeconds;
+    std::vector<int> ref = run_reference(model, images, model.params.activationChance, 1000, refSeconds);
+    std::vector<int> ref2 = run_reference(model, images, model.params.activationChance, 2000, refSeconds2);
+    std::vector<int> quiet = run_reference(model, images, 0.0, 3000, quietSeconds);
+
+    auto buildStart = Clock::now();
+    InferenceEngine fixedEngine(model);
+    buildSeconds = seconds_since(buildStart);
+    InferenceEngine randomEngine(model, model.params.activationChance);
+    FrozenDoubleEngine frozenEngine(model);
+    FrozenDoubleEngine frozenRandomEngine(model, model.params.activationChance);
+    std::vector<int> fixed = run_engine(fixedEngine, images, fixedSeconds);
+    std::vector<int> random = run_engine(randomEngine, images, randomSeconds);
+    std::vector<int> frozen = run_engine(frozenEngine, images, frozenSeconds);
+    std::vector<int> frozenRandom = run_engine(frozenRandomEngine, images, frozenRandomSeconds);
+
+    std::cout << "模型: " << modelPath << "  神经元: " << fixedEngine.getNeuronCount()
+              << "  突触: " << fixedEngine.getSynapseCount() << "  图片: " << images.size()
+              << "  引擎构建: " << std::fixed << std::setprecision(2) << buildSeconds * 1000 << " ms" << std::endl;
+    std::cout << std::left << std::setw(30) << "" << std::right << std::setw(12) << "图片/秒"
+              << std::setw(10) << "准确率" << std::setw(10) << "一致率" << "  对照" << std::endl;
+    auto row = [&](const char* name, const std::vector<int>& results, double seconds, double agree,
+                   const char* against) {
+        std::cout << std::left << std::setw(30) << name << std::right << std::setw(12) << std::setprecision(1)
+                  << images.size() / seconds << std::setw(10) << std::setprecision(3) << accuracy(results, images)
+                  << std::setw(10) << agree << "  " << against << std::endl;
+    };
+    row("原实现（两次运行）", ref, refSeconds, agreement(ref, ref2), "原实现（噪声基线）");
+    row("原实现（无随机激活）", quiet, quietSeconds, agreement(quiet, ref), "原实现");
+    row("冻结 double（无随机激活）", frozen, frozenSeconds, agreement(frozen, quiet), "原实现（无随机激活）：冻结的拓扑和可塑性");
+    row("定点引擎（无随机激活）", fixed, fixedSeconds, agreement(fixed, frozen), "冻结 double：量化");
+    row("冻结 double（随机激活）", frozenRandom, frozenRandomSeconds, agreement(frozenRandom, ref),
+        "原实现：冻结的拓扑和可塑性");
+    row("定点引擎（随机激活）", random, randomSeconds, agreement(random, frozenRandom), "冻结 double：量化");
+    std::cout << "加速比: " << std::setprecision(1) << refSeconds / fixedSeconds << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "neuron_sim.h"
+#include "spiking_kernel.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+// 比较不同 标量类型 × 神经元模型 × 可塑性规则 组合的内核速度
+// 用法: model_policies [神经元数] [步数]
+
+template <typename Scalar, template <typename> class Model, template <typename> class Rule>
+static void run(const std::string& name, const NeuralNetworkSimulation& sim, int steps) {
+    SpikingKernel<Scalar, Model, Rule> kernel(sim, 12345);
+    for (int i = 0; i < 20; ++i) kernel.step();  // 预热
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) kernel.step();
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    double meanActivation = 0;
+    for (size_t i = 0; i < kernel.getNeuronCount(); ++i) {
+        meanActivation += static_cast<double>(kernel.getActivationLevel(i));
+    }
+    meanActivation /= kernel.getNeuronCount();
+
+    std::cout << std::left << std::setw(34) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(0) << steps / seconds
+              << std::setw(16) << std::setprecision(2) << seconds * 1e9 / steps / kernel.getNeuronCount()
+              << std::setw(16) << seconds * 1e9 / steps / std::max<size_t>(1, kernel.getSynapseCount())
+              << std::setw(12) << std::setprecision(4) << meanActivation << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int numNeurons = argc > 1 ? std::stoi(argv[1]) : 3000;
+    int steps = argc > 2 ? std::stoi(argv[2]) : 500;
+
+    // 先用完整模拟跑几步建立突触，再冻结拓扑
+    NeuralNetworkSimulation sim(numNeurons, 1000, 800, 60);
+    sim.reorderInterval = 0;
+    for (int i = 0; i < 5; ++i) sim.step();
+    sim.reorderByLocality();
+    std::cout << "神经元: " << numNeurons << "  突触: " << sim.getTotalSynapses() << "  步数: " << steps << std::endl;
+
+    std::cout << std::left << std::setw(34) << "组合" << std::right << std::setw(12) << "步/秒"
+              << std::setw(16) << "ns/神经元步" << std::setw(16) << "ns/突触步" << std::setw(12) << "平均激活" << std::endl;
+    run<double, LifModel, NoPlasticity>("double LIF 固定权重", sim, steps);
+    run<float, LifModel, NoPlasticity>("float  LIF 固定权重", sim, steps);
+    run<double, LifModel, DecayStrengthenPlasticity>("double LIF 衰减/增强(当前规则)", sim, steps);
+    run<float, LifModel, DecayStrengthenPlasticity>("float  LIF 衰减/增强(当前规则)", sim, steps);
+    run<double, LifModel, StdpPlasticity>("double LIF STDP", sim, steps);
+    run<float, LifModel, StdpPlasticity>("float  LIF STDP", sim, steps);
+    run<double, IzhikevichModel, NoPlasticity>("double Izhikevich 固定权重", sim, steps);
+    run<float, IzhikevichModel, NoPlasticity>("float  Izhikevich 固定权重", sim, steps);
+    run<double, IzhikevichModel, StdpPlasticity>("double Izhikevich STDP", sim, steps);
+    run<float, IzhikevichModel, StdpPlasticity>("float  Izhikevich STDP", sim, steps);
+
+    // 对照：完整模拟中同样的动力学分散在每个 Neuron 对象里，且每步还包含移动和O(N^2)的连接检查
+    auto start = std::chrono::steady_clock::now();
+    const int referenceSteps = 5;
+    for (int i = 0; i < referenceSteps; ++i) sim.step();
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "对照 NeuralNetworkSimulation::step: "
+              << std::setprecision(0) << referenceSteps / std::chrono::duration<double>(end - start).count()
+              << " 步/秒" << std::endl;
+    return 0;
+}
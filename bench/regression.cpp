@@ -0,0 +1,444 @@
+#include "neuron_sim.h"
+#include "img_char_number.h"
+#include "inference.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <filesystem>
+#include <cstdlib>
+#include <cmath>
+#include <unistd.h>
+
+// 性能回归测试：固定种子，每个用例先预热，再重复运行取中位数和标准差，
+// 结果写成JSON并与保存的基线比较。中位数变慢同时超过阈值（百分比）和 k 倍噪声
+// （本次与基线标准差中的较大者）的用例记为回归；工作量与基线不同说明行为已改变，同样记为失败（退出码1），
+// 基线中的用例没有运行（未用 --filter 排除）也记为失败。
+// 基线记录生成它的机器（CPU型号和线程数）。工作量与机器无关，任何机器上都必须与基线相同；
+// 耗时只在同一台机器上比较，其他机器上只作参考。默认使用本机基线 bench/baseline.local.json
+// （不纳入版本库，用 --update-baseline 生成；配合 --filter 时只更新匹配的用例，其余保持不变），
+// 不存在时使用版本库中参考机器的 bench/baseline.json。没有基线时直接失败。
+// 需要在仓库根目录运行（PNG 和识别用例读取 DIGIT_TRAIN_DIR）。
+// 用法: regression [--baseline 文件] [--out 文件] [--threshold 百分比] [--sigma k] [--repeats N]
+//                  [--filter 子串] [--update-baseline]
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+static const uint64_t BENCH_SEED = 20240601;
+static const double MIN_SAMPLE_MS = 200;   // 单次 run 很短的用例在一个样本内重复运行，直到累计达到该时长
+static const char* const LOCAL_BASELINE = "bench/baseline.local.json";
+static const char* const REFERENCE_BASELINE = "bench/baseline.json";
+
+struct CaseResult {
+    std::string name;
+    std::string unit;
+    double median = 0, mean = 0, stddev = 0, min = 0, max = 0;
+    int repeats = 0;
+    uint64_t work = 0;   // 用例完成的工作量（如突触数），与基线不同时说明行为已改变，耗时不可直接比较
+};
+
+// 一个用例：构造时准备好状态（不计时），run 执行一次被计时的工作并返回每单位耗时
+struct BenchCase {
+    std::string name;
+    std::string unit;
+    int warmup;
+    std::function<double()> run;
+    std::function<uint64_t()> work;
+};
+
+static double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 一个样本：重复 run 直到累计耗时达到 MIN_SAMPLE_MS，取各次结果的平均值
+static double sample(const BenchCase& bench) {
+    auto start = Clock::now();
+    double total = 0;
+    int runs = 0;
+    do {
+        total += bench.run();
+        runs++;
+    } while (elapsed_ms(start) < MIN_SAMPLE_MS);
+    return total / runs;
+}
+
+static CaseResult measure(const BenchCase& bench, int repeats) {
+    for (int i = 0; i < bench.warmup; ++i) bench.run();
+    std::vector<double> samples;
+    for (int i = 0; i < repeats; ++i) samples.push_back(sample(bench));
+
+    CaseResult result;
+    result.name = bench.name;
+    result.unit = bench.unit;
+    result.repeats = repeats;
+    std::sort(samples.begin(), samples.end());
+    size_t mid = samples.size() / 2;
+    result.median = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+    result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    double variance = 0;
+    for (double s : samples) variance += (s - result.mean) * (s - result.mean);
+    result.stddev = samples.size() > 1 ? std::sqrt(variance / (samples.size() - 1)) : 0.0;
+    result.min = samples.front();
+    result.max = samples.back();
+    result.work = bench.work ? bench.work() : 0;
+    return result;
+}
+
+// 本机标识：CPU型号和线程数，写入结果文件，用于判断耗时能否与基线比较
+static std::string machine_id() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line, model = "unknown";
+    int threads = 0;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("processor", 0) == 0) threads++;
+        if (model == "unknown" && line.rfind("model name", 0) == 0 && line.find(':') != std::string::npos) {
+            model = line.substr(line.find_first_not_of(" \t", line.find(':') + 1));
+        }
+    }
+    // JSON字符串中不能出现引号和反斜杠
+    model.erase(std::remove_if(model.begin(), model.end(), [](char c) { return c == '"' || c == '\\'; }), model.end());
+    return model + " x" + std::to_string(threads);
+}
+
+static std::string temp_model_path() {
+    return (fs::temp_directory_path() / ("neuron_regression_" + std::to_string(getpid()) + ".bin")).string();
+}
+
+static SimulationParams bench_params(double threshold) {
+    SimulationParams params;
+    params.connectionThreshold = threshold;
+    params.seed = BENCH_SEED;
+    return params;
+}
+
+// step()：预热后的网络每次复制一份运行相同步数，保证每次重复的工作相同
+static BenchCase step_case(int numNeurons, int steps) {
+    auto warmed = std::make_shared<NeuralNetworkSimulation>(numNeurons, 1000, 800,
+                                                            bench_params(SimulationParams().connectionThreshold));
+    for (int i = 0; i < 50; ++i) warmed->step();
+    auto synapses = std::make_shared<uint64_t>(0);
+    return {"step_" + std::to_string(numNeurons), "ms/步", 1,
+            [=] {
+                NeuralNetworkSimulation sim = *warmed;
+                auto start = Clock::now();
+                for (int i = 0; i < steps; ++i) sim.step();
+                double ms = elapsed_ms(start) / steps;
+                *synapses = sim.getTotalSynapses();
+                return ms;
+            },
+            [=] { return *synapses; }};
+}
+
+// connectTo 反复建立和失活：每轮连接全部目标，再让突触因长时间未使用而失活，下一轮复用空槽
+static BenchCase connect_churn_case(int targets, int rounds) {
+    return {"connect_churn", "ns/连接", 1,
+            [=] {
+                std::mt19937 gen(BENCH_SEED);
+                Neuron neuron(0, 0, gen);
+                double t = 0;
+                auto start = Clock::now();
+                for (int r = 0; r < rounds; ++r) {
+                    for (int target = 0; target < targets; ++target) {
+                        neuron.connectTo((target * 7 + r) % (targets * 2), 0.5, t);
+                    }
+                    t += Synapse::INACTIVITY_THRESHOLD + 1;
+                    neuron.updateSynapses(t);
+                }
+                return elapsed_ms(start) * 1e6 / (static_cast<double>(targets) * rounds);
+            },
+            [=] { return static_cast<uint64_t>(targets) * rounds; }};
+}
+
+// 模型保存/加载：预热网络的突触表写入临时文件再读回
+static void save_load_cases(std::vector<BenchCase>& cases) {
+    auto model = std::make_shared<NeuralNetworkSimulation>(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT,
+                                                           bench_params(DIGIT_THRESHOLD));
+    for (int i = 0; i < 50; ++i) model->step();
+    auto path = std::make_shared<std::string>(temp_model_path());
+    auto synapses = [=] { return static_cast<uint64_t>(model->getTotalSynapses()); };
+
+    cases.push_back({"model_save", "ms", 1,
+                     [=] {
+                         auto start = Clock::now();
+                         save_training_result(*model, *path);
+                         return elapsed_ms(start);
+                     },
+                     synapses});
+    cases.push_back({"model_load", "ms", 1,
+                     [=] {
+                         if (!fs::exists(*path)) save_training_result(*model, *path);
+                         NeuralNetworkSimulation loaded(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT,
+                                                        bench_params(DIGIT_THRESHOLD));
+                         auto start = Clock::now();
+                         load_training_result(loaded, *path);
+                         return elapsed_ms(start);
+                     },
+                     synapses});
+}
+
+// PNG预处理（解码 + 缩放 + 灰度化）：每个数字取前几张训练图片
+static void png_case(std::vector<BenchCase>& cases, const std::vector<DigitSample>& samples) {
+    if (samples.empty()) return;
+    cases.push_back({"png_preprocess", "ms/张", 1,
+                     [=] {
+                         auto start = Clock::now();
+                         for (const auto& sample : samples) {
+                             load_png_image(sample.path, DIGIT_INPUT_WIDTH, DIGIT_INPUT_HEIGHT);
+                         }
+                         return elapsed_ms(start) / samples.size();
+                     },
+                     [=] { return static_cast<uint64_t>(samples.size()); }});
+}
+
+// 端到端识别：固定种子训练一个小模型，保存再加载（与 recognize 相同），
+// 分别用 recognize_digit 和定点引擎识别同一批图片
+static void recognize_cases(std::vector<BenchCase>& cases, const std::vector<DigitImage>& images) {
+    if (images.empty()) return;
+    SimulationParams params = bench_params(DIGIT_THRESHOLD);
+    params.trainSteps = 50;
+    NeuralNetworkSimulation trained(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, params);
+    for (const auto& image : images) train_on_image(trained, image.img, image.digit);
+
+    std::string path = temp_model_path();
+    auto model = std::make_shared<NeuralNetworkSimulation>(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, params);
+    bool ok = save_training_result(trained, path) && load_training_result(*model, path);
+    fs::remove(path);
+    if (!ok) return;
+    auto synapses = [=] { return static_cast<uint64_t>(model->getTotalSynapses()); };
+
+    cases.push_back({"recognize_reference", "ms/张", 0,
+                     [=] {
+                         auto start = Clock::now();
+                         for (size_t i = 0; i < images.size(); ++i) {
+                             NeuralNetworkSimulation copy = *model;
+                             copy.reseed(BENCH_SEED + i);
+                             recognize_digit(copy, images[i].img);
+                         }
+                         return elapsed_ms(start) / images.size();
+                     },
+                     synapses});
+    cases.push_back({"recognize_fixed", "ms/张", 1,
+                     [=] {
+                         auto start = Clock::now();
+                         InferenceEngine engine(*model);
+                         for (const auto& image : images) engine.recognize(image.img);
+                         return elapsed_ms(start) / images.size();
+                     },
+                     synapses});
+}
+
+static std::string to_json(const std::string& machine, const std::vector<CaseResult>& results) {
+    std::ostringstream out;
+    out << std::setprecision(6) << "{\n  \"machine\": \"" << machine << "\",\n  \"cases\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\", \"median\": " << r.median
+            << ", \"mean\": " << r.mean << ", \"stddev\": " << r.stddev << ", \"min\": " << r.min
+            << ", \"max\": " << r.max << ", \"repeats\": " << r.repeats << ", \"work\": " << r.work << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+// 读取 to_json 写出的基线（机器和每个用例各占一行），order 按文件中的顺序记录用例名
+static bool load_baseline(const std::string& path, std::string& machine, std::map<std::string, CaseResult>& baseline,
+                          std::vector<std::string>& order) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    auto field = [](const std::string& line, const std::string& key) -> std::string {
+        size_t pos = line.find("\"" + key + "\":");
+        if (pos == std::string::npos) return "";
+        pos = line.find_first_not_of(" \"", pos + key.size() + 3);
+        size_t end = line.find_first_of(",\"}", pos);
+        return pos == std::string::npos ? "" : line.substr(pos, end - pos);
+    };
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.find("\"machine\":") != std::string::npos) {
+            size_t begin = line.find('"', line.find(':')) + 1;
+            machine = line.substr(begin, line.rfind('"') - begin);
+            continue;
+        }
+        std::string name = field(line, "name");
+        if (name.empty()) continue;
+        CaseResult r;
+        r.name = name;
+        r.unit = field(line, "unit");
+        r.median = std::atof(field(line, "median").c_str());
+        r.mean = std::atof(field(line, "mean").c_str());
+        r.stddev = std::atof(field(line, "stddev").c_str());
+        r.min = std::atof(field(line, "min").c_str());
+        r.max = std::atof(field(line, "max").c_str());
+        r.repeats = std::atoi(field(line, "repeats").c_str());
+        r.work = std::strtoull(field(line, "work").c_str(), nullptr, 10);
+        if (!baseline.count(name)) order.push_back(name);
+        baseline[name] = r;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string baselinePath;
+    std::string outPath = "out/bench.json";
+    std::string filter;
+    double threshold = 10.0;
+    double sigma = 3.0;
+    int repeats = 5;
+    bool updateBaseline = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+        else if (arg == "--out" && hasValue) outPath = argv[++i];
+        else if (arg == "--threshold" && hasValue) threshold = std::stod(argv[++i]);
+        else if (arg == "--sigma" && hasValue) sigma = std::stod(argv[++i]);
+        else if (arg == "--repeats" && hasValue) repeats = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--filter" && hasValue) filter = argv[++i];
+        else if (arg == "--update-baseline") updateBaseline = true;
+        else {
+            std::cerr << "用法: " << argv[0] << " [--baseline 文件] [--out 文件] [--threshold 百分比] [--sigma k]"
+                      << " [--repeats N] [--filter 子串] [--update-baseline]" << std::endl;
+            return 1;
+        }
+    }
+
+    // 更新基线时也读取已有基线，--filter 只替换匹配的用例。未指定基线时优先使用本机基线；
+    // 更新时总是写本机基线，参考基线需要显式 --baseline bench/baseline.json 更新
+    if (baselinePath.empty()) {
+        baselinePath = updateBaseline || fs::exists(LOCAL_BASELINE) ? LOCAL_BASELINE : REFERENCE_BASELINE;
+    }
+    const std::string machine = machine_id();
+    std::string baselineMachine;
+    std::map<std::string, CaseResult> baseline;
+    std::vector<std::string> baselineOrder;
+    bool haveBaseline = load_baseline(baselinePath, baselineMachine, baseline, baselineOrder);
+    if (!updateBaseline && !haveBaseline) {
+        std::cerr << "没有基线文件: " << baselinePath << "（在本机用 make bench-baseline 或 --update-baseline 生成）"
+                  << std::endl;
+        return 1;
+    }
+    // 其他机器生成的基线只比较工作量；在本机更新时不保留其他机器的用例
+    const bool compareTimes = baselineMachine == machine;
+    if (updateBaseline && !compareTimes) {
+        baseline.clear();
+        baselineOrder.clear();
+    }
+
+    // 识别和PNG用例使用每个数字的第1张图片
+    std::vector<DigitSample> firstOfDigit;
+    std::vector<bool> seen(DIGIT_COUNT, false);
+    for (const auto& sample : list_digit_samples(DIGIT_TRAIN_DIR)) {
+        if (!seen[sample.digit]) {
+            seen[sample.digit] = true;
+            firstOfDigit.push_back(sample);
+        }
+    }
+    std::vector<DigitImage> images = load_digit_images(firstOfDigit, 1);
+    if (images.size() > 2) images.resize(2);
+
+    std::vector<BenchCase> cases;
+    for (int n : {200, 794, 2000}) cases.push_back(step_case(n, n <= 794 ? 20 : 5));
+    cases.push_back(connect_churn_case(256, 200));
+    save_load_cases(cases);
+    png_case(cases, firstOfDigit);
+    recognize_cases(cases, images);
+    if (firstOfDigit.empty()) {
+        std::cerr << "未找到训练图片（" << DIGIT_TRAIN_DIR << "），跳过PNG和识别用例" << std::endl;
+    }
+
+    std::cout << "本机: " << machine << std::endl;
+    if (!updateBaseline) {
+        std::cout << "基线: " << baselinePath << "（" << (baselineMachine.empty() ? "未知机器" : baselineMachine) << "）";
+        if (!compareTimes) std::cout << "  其他机器生成，只比较工作量，耗时仅供参考";
+        std::cout << std::endl;
+    }
+    std::cout << "重复: " << repeats << "  回归阈值: " << threshold << "% 且超过 " << sigma << " 倍标准差" << std::endl;
+    std::cout << std::left << std::setw(22) << "用例" << std::right << std::setw(12) << "中位数"
+              << std::setw(10) << "标准差" << std::setw(12) << "基线" << std::setw(10) << "变化" << "  单位" << std::endl;
+
+    std::vector<CaseResult> results;
+    int regressions = 0, workMismatches = 0;
+    for (const auto& bench : cases) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        CaseResult r = measure(bench, repeats);
+        results.push_back(r);
+
+        std::cout << std::left << std::setw(22) << r.name << std::right << std::fixed << std::setprecision(4)
+                  << std::setw(12) << r.median << std::setw(10) << r.stddev;
+        auto it = baseline.find(r.name);
+        if (!updateBaseline && it != baseline.end() && it->second.median > 0) {
+            double change = 100.0 * (r.median - it->second.median) / it->second.median;
+            double noise = std::max(r.stddev, it->second.stddev);
+            std::cout << std::setw(12) << it->second.median << std::setw(9) << std::setprecision(1)
+                      << std::showpos << change << "%" << std::noshowpos << "  " << r.unit;
+            if (!compareTimes) {
+                // 不同机器的耗时不可比较
+            } else if (change > threshold && r.median - it->second.median > sigma * noise) {
+                std::cout << "  回归";
+                regressions++;
+            } else if (change > threshold) {
+                std::cout << "  （在噪声范围内）";
+            }
+            if (it->second.work != r.work) {
+                std::cout << "  工作量不同（基线 " << it->second.work << "，当前 " << r.work << "）";
+                workMismatches++;
+            }
+        } else {
+            std::cout << std::setw(12) << "-" << std::setw(10) << "-" << "  " << r.unit;
+        }
+        std::cout << std::endl;
+    }
+
+    // 基线中的用例必须都运行过（--filter 排除的除外），否则缺少图片等情况会悄悄跳过检查
+    int missing = 0;
+    if (!updateBaseline) {
+        for (const auto& name : baselineOrder) {
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+            if (std::none_of(results.begin(), results.end(), [&](const CaseResult& r) { return r.name == name; })) {
+                std::cout << std::left << std::setw(22) << name << "  未运行（基线中有该用例）" << std::endl;
+                missing++;
+            }
+        }
+    }
+
+    fs::remove(temp_model_path());
+    std::string target = updateBaseline ? baselinePath : outPath;
+    std::vector<CaseResult> written = results;
+    if (updateBaseline) {
+        // 已有基线中未重新测量的用例原样保留，按原顺序排在前面
+        written.clear();
+        for (const auto& name : baselineOrder) {
+            auto measured = std::find_if(results.begin(), results.end(),
+                                         [&](const CaseResult& r) { return r.name == name; });
+            written.push_back(measured != results.end() ? *measured : baseline[name]);
+        }
+        for (const auto& r : results) {
+            if (!baseline.count(r.name)) written.push_back(r);
+        }
+    }
+    if (fs::path(target).has_parent_path()) fs::create_directories(fs::path(target).parent_path());
+    std::ofstream(target) << to_json(machine, written);
+    std::cout << "结果已写入: " << target << std::endl;
+
+    if (regressions > 0) {
+        std::cout << regressions << " 个用例超过回归阈值" << std::endl;
+    }
+    if (workMismatches > 0) {
+        std::cout << workMismatches << " 个用例的工作量与基线不同（行为已改变，确认后用 --update-baseline 更新基线）"
+                  << std::endl;
+    }
+    if (missing > 0) {
+        std::cout << missing << " 个基线用例没有运行" << std::endl;
+    }
+    return regressions > 0 || workMismatches > 0 || missing > 0 ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+#include "neuron_sim.h"
+#include "network_renderer.h"
+#include "render_snapshot.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+
+// 帧耗时与神经元数量的关系：逐条绘制（原实现）/ 分桶批量绘制 / 自动切换密度图，
+// 以及两种新绘制方式相对逐条绘制的加速比。耗时取决于 cairo 的光栅化实现，
+// 表头打印运行时链接的 cairo 版本，贴出结果时一并注明
+// 用法: render [帧数]
+
+// 原 draw_callback 的绘制方式，作为对照
+static void render_reference(cairo_t* cr, const NeuralNetworkSimulation& sim) {
+    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
+    cairo_paint(cr);
+    for (const auto& neuron : sim.neurons) {
+        const auto& synapses = neuron.getActiveSynapses();
+        const auto& pos = neuron.getPosition();
+        for (const auto& synapse : synapses) {
+            const auto& targetPos = sim.neurons[synapse.targetNeuron].getPosition();
+            cairo_set_source_rgba(cr, 0.5, 0.8, 1.0, synapse.strength);
+            cairo_set_line_width(cr, 0.5 + (synapse.strength * 1.5));
+            cairo_move_to(cr, pos.x, pos.y);
+            cairo_line_to(cr, targetPos.x, targetPos.y);
+            cairo_stroke(cr);
+        }
+    }
+    for (const auto& neuron : sim.neurons) {
+        const auto& pos = neuron.getPosition();
+        double activation = neuron.getActivationLevel();
+        if (neuron.firing()) {
+            cairo_set_source_rgb(cr, 1.0, 0.2, 0.2);
+        } else {
+            cairo_set_source_rgb(cr, 0.3, 0.5 + activation * 0.5, 1.0);
+        }
+        double radius = 5.0 + (activation * 3.0);
+        cairo_arc(cr, pos.x, pos.y, radius, 0, 2 * M_PI);
+        cairo_fill(cr);
+        cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
+        cairo_set_line_width(cr, 1.0);
+        cairo_arc(cr, pos.x, pos.y, radius, 0, 2 * M_PI);
+        cairo_stroke(cr);
+    }
+}
+
+template <typename Draw>
+static double time_frames(int frames, Draw draw) {
+    draw();  // 预热（图元缓存等）
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) draw();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+int main(int argc, char* argv[]) {
+    const int WIDTH = 1000, HEIGHT = 800;
+    const double THRESHOLD = 250;
+    int frames = argc > 1 ? std::stoi(argv[1]) : 10;
+
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+    cairo_t* cr = cairo_create(surface);
+
+    std::cout << "cairo " << cairo_version_string() << "  " << WIDTH << "x" << HEIGHT << "  连接阈值 " << THRESHOLD
+              << "  每种方式 " << frames << " 帧" << std::endl;
+    std::cout << std::setw(10) << "神经元数" << std::setw(12) << "突触数"
+              << std::setw(14) << "逐条(ms)" << std::setw(14) << "分桶(ms)" << std::setw(14) << "自动(ms)"
+              << std::setw(10) << "分桶加速" << std::setw(10) << "自动加速" << std::setw(10) << "密度图" << std::endl;
+    for (int n : {100, 200, 500, 1000, 2000}) {
+        NeuralNetworkSimulation sim(n, WIDTH, HEIGHT, THRESHOLD);
+        sim.step();
+        RenderSnapshot snapshot;
+        snapshot.capture(sim, false);
+
+        NetworkRenderer batched, automatic;
+        batched.setDensityThreshold(0);
+        double reference = time_frames(frames, [&] { render_reference(cr, sim); });
+        double bucketed = time_frames(frames, [&] { batched.render(cr, snapshot, WIDTH, HEIGHT, nullptr); });
+        double lod = time_frames(frames, [&] { automatic.render(cr, snapshot, WIDTH, HEIGHT, nullptr); });
+
+        std::cout << std::setw(10) << n << std::setw(12) << sim.getTotalSynapses()
+                  << std::setw(14) << std::fixed << std::setprecision(2) << reference
+                  << std::setw(14) << bucketed << std::setw(14) << lod
+                  << std::setw(10) << reference / bucketed << std::setw(10) << reference / lod
+                  << std::setw(10) << (automatic.lastFrameUsedDensity() ? "是" : "否") << std::endl;
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "neuron_sim.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// 硬件缓存未命中计数器（内核不允许时返回-1，只报告耗时）
+static int open_cache_miss_counter() {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// 按网格查找邻居建立连接，模拟运行一段时间后的突触分布（避免step()的O(N^2)连接检查）
+static void build_synapses(NeuralNetworkSimulation& sim) {
+    const double cell = sim.params.connectionThreshold;
+    const int cols = static_cast<int>(sim.width / cell) + 1;
+    const int rows = static_cast<int>(sim.height / cell) + 1;
+    std::vector<std::vector<int>> grid(cols * rows);
+    for (size_t i = 0; i < sim.neurons.size(); ++i) {
+        const auto& p = sim.neurons[i].getPosition();
+        grid[static_cast<int>(p.y / cell) * cols + static_cast<int>(p.x / cell)].push_back(i);
+    }
+    for (size_t i = 0; i < sim.neurons.size(); ++i) {
+        const auto& p = sim.neurons[i].getPosition();
+        int cx = static_cast<int>(p.x / cell), cy = static_cast<int>(p.y / cell);
+        for (int y = std::max(0, cy - 1); y <= std::min(rows - 1, cy + 1); ++y) {
+            for (int x = std::max(0, cx - 1); x <= std::min(cols - 1, cx + 1); ++x) {
+                for (int j : grid[y * cols + x]) {
+                    if (static_cast<int>(i) != j && sim.neurons[i].isCloseEnough(sim.neurons[j], cell)) {
+                        sim.neurons[i].connectTo(j, 0.5, 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 与step()中信号传递相同的访存模式：遍历每个神经元的突触并读取目标神经元
+static double propagate(const NeuralNetworkSimulation& sim) {
+    double sum = 0.0;
+    for (const auto& neuron : sim.neurons) {
+        for (const auto& synapse : neuron.getSynapses()) {
+            if (synapse.isActive) {
+                sum += synapse.strength * sim.neurons[synapse.targetNeuron].getActivationLevel();
+            }
+        }
+    }
+    return sum;
+}
+
+struct Measurement {
+    double msPerPass;
+    long long missesPerPass;
+};
+
+static Measurement measure(const NeuralNetworkSimulation& sim, int passes, int counter) {
+    volatile double sink = propagate(sim);  // 预热
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < passes; ++i) {
+        sink = sink + propagate(sim);
+    }
+    auto end = std::chrono::steady_clock::now();
+    long long misses = -1;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &misses, sizeof(misses)) != sizeof(misses)) misses = -1;
+        else misses /= passes;
+    }
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    return {elapsed.count() / passes, misses};
+}
+
+int main() {
+    const int counter = open_cache_miss_counter();
+    if (counter < 0) {
+        std::cout << "perf_event_open 不可用，仅报告耗时" << std::endl;
+    }
+    
+    std::cout << std::setw(10) << "神经元数" << std::setw(12) << "突触数"
+              << std::setw(14) << "重排前(ms)" << std::setw(14) << "重排后(ms)"
+              << std::setw(16) << "重排前miss" << std::setw(16) << "重排后miss" << std::endl;
+    
+    for (int n : {10000, 50000, 200000}) {
+        // 保持平均邻居数不变，空间随神经元数扩大
+        double side = std::sqrt(static_cast<double>(n)) * 20.0;
+        NeuralNetworkSimulation sim(n, side, side, 30.0);
+        build_synapses(sim);
+        
+        const int passes = 20;
+        Measurement before = measure(sim, passes, counter);
+        sim.reorderByLocality();
+        Measurement after = measure(sim, passes, counter);
+        
+        std::cout << std::setw(10) << n << std::setw(12) << sim.getTotalSynapses()
+                  << std::setw(14) << std::fixed << std::setprecision(3) << before.msPerPass
+                  << std::setw(14) << after.msPerPass
+                  << std::setw(16) << before.missesPerPass
+                  << std::setw(16) << after.missesPerPass << std::endl;
+    }
+    
+    if (counter >= 0) close(counter);
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "neuron_sim.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <new>
+
+// 稳态 step() 的堆分配检查：替换全局 operator new 计数，网络预热后再运行若干步。
+// 允许的分配只有两种：
+// 1. 某个神经元的突触数达到新高、突触存储升到下一个大小级别（每次升级恰好一次分配，
+//    按各神经元突触数组容量的变化计数，神经元按外部ID对应，不受重排影响）
+// 2. 每 reorderInterval 步的重排按空间顺序复制突触数组（每个非空数组恰好一次分配）
+// 除此之外发生任何堆分配即以退出码1失败。make bench-check 会先运行本检查。
+// 用法: step_alloc [神经元数] [预热步数] [检查步数]
+
+static size_t allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    allocationCount++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, char* argv[]) {
+    int numNeurons = argc > 1 ? std::stoi(argv[1]) : 300;
+    int warmupSteps = argc > 2 ? std::stoi(argv[2]) : 10000;
+    int checkSteps = argc > 3 ? std::stoi(argv[3]) : 1000;
+
+    SimulationParams params;
+    params.seed = 20240601;
+    NeuralNetworkSimulation sim(numNeurons, 800, 600, params);
+    for (int i = 0; i < warmupSteps; ++i) sim.step();
+
+    std::vector<size_t> capacity(sim.neurons.size());
+    for (size_t i = 0; i < capacity.size(); ++i) capacity[i] = sim.neuronById(i).getSynapses().capacity();
+
+    size_t allocations = 0, growths = 0, reorderCopies = 0, reorders = 0;
+    for (int step = 0; step < checkSteps; ++step) {
+        size_t before = allocationCount;
+        sim.step();
+        allocations += allocationCount - before;
+        for (size_t i = 0; i < capacity.size(); ++i) {
+            size_t current = sim.neuronById(i).getSynapses().capacity();
+            if (current != capacity[i]) {
+                capacity[i] = current;
+                growths++;
+            }
+        }
+        if (sim.reorderInterval > 0 && sim.currentStep % sim.reorderInterval == 0) {
+            reorders++;
+            for (size_t i = 0; i < capacity.size(); ++i) {
+                if (capacity[i] > 0) reorderCopies++;
+            }
+        }
+    }
+
+    std::cout << "神经元: " << numNeurons << "  预热: " << warmupSteps << " 步  检查: " << checkSteps
+              << " 步  突触: " << sim.getTotalSynapses() << "  堆分配: " << allocations
+              << "（其中突触存储升级: " << growths << "，" << reorders << " 次重排复制: " << reorderCopies
+              << "）" << std::endl;
+    if (allocations != growths + reorderCopies) {
+        std::cout << "稳态 step() 发生了堆分配" << std::endl;
+        return 1;
+    }
+    return 0;
+}
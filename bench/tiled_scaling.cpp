@@ -0,0 +1,146 @@
+#include "tiled_sim.h"
+#include "img_char_number.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cmath>
+
+// 用法: tiled_scaling [神经元数] [步数] [最大进程数] [参数=值 ...]
+// 参数与 train 相同（threshold、chance、lr、decay），连接阈值默认为30
+// 一致性：确定性配置（神经元不移动、没有随机激活、定期刺激固定的神经元）下，
+// NeuralNetworkSimulation 与 1..最大进程数的分块模拟应得到相同的突触数、脉冲源总数和
+// 被突触输入触发的发放总数
+// 强扩展：神经元总数固定，进程数递增；弱扩展：每个进程的神经元数和面积固定
+// 一致性不满足、任何一次运行丢弃了脉冲或神经元数不守恒时以退出码1结束
+
+static void print_header() {
+    std::cout << std::setw(8) << "进程数" << std::setw(12) << "神经元数" << std::setw(12) << "耗时(s)"
+              << std::setw(10) << "加速比" << std::setw(10) << "效率"
+              << std::setw(12) << "跨块脉冲" << std::setw(10) << "丢弃" << std::setw(10) << "迁移数"
+              << std::setw(8) << "守恒" << std::endl;
+}
+
+// 与分块模拟的确定性配置相同的单进程模拟：同一种子，速度置0，在 step() 前刺激
+static void run_reference(const TiledSimulationConfig& config, long long& fires, long long& induced,
+                          long long& synapses) {
+    SimulationParams params = config.params;
+    params.seed = config.seed;
+    NeuralNetworkSimulation sim(config.numNeurons, config.width, config.height, params);
+    for (auto& neuron : sim.neurons) {
+        NeuronState state = neuron.getState();
+        state.speed = 0;
+        neuron = Neuron(state, std::vector<Synapse>());
+    }
+    sim.refreshActiveSet();
+    fires = induced = 0;
+    for (int s = 0; s < config.steps; ++s) {
+        if (s % config.stimulusInterval == 0) {
+            for (int id = 0; id < config.numNeurons; id += config.stimulusStride) sim.stimulate(id);
+        }
+        fires += static_cast<long long>(sim.getFiringCount());
+        sim.step();
+        // 没有随机激活时，本步发放过的只有被突触输入推过阈值的神经元
+        for (const auto& neuron : sim.neurons) {
+            if (neuron.getLastFired() == sim.currentStep) induced++;
+        }
+    }
+    synapses = static_cast<long long>(sim.getTotalSynapses());
+}
+
+static bool check_consistency(int maxTiles, const SimulationParams& base, double density) {
+    const int numNeurons = 2000;
+    const double side = std::sqrt(numNeurons / density);
+    SimulationParams params = base;
+    params.activationChance = 0.0;
+    TiledSimulationConfig config{numNeurons, side, side, 1, 150, 42, params};
+    config.moveNeurons = false;
+    config.stimulusInterval = 25;
+    config.stimulusStride = 4;
+
+    long long fires, induced, synapses;
+    run_reference(config, fires, induced, synapses);
+    std::cout << "== 一致性 (" << numNeurons << " 个神经元, " << config.steps << " 步, 不移动) ==" << std::endl;
+    std::cout << std::setw(14) << "后端" << std::setw(12) << "脉冲源" << std::setw(12) << "触发发放"
+              << std::setw(12) << "突触数" << std::setw(10) << "丢弃" << std::setw(8) << "一致" << std::endl;
+    std::cout << std::setw(14) << "单进程模拟" << std::setw(12) << fires << std::setw(12) << induced
+              << std::setw(12) << synapses << std::endl;
+
+    bool ok = true;
+    for (int tiles = 1; tiles <= maxTiles; tiles *= 2) {
+        config.numTiles = tiles;
+        TiledSimulationResult r = runTiledSimulation(config);
+        bool same = r.ok && r.fires == fires && r.inducedFires == induced && r.activeSynapses == synapses &&
+                    r.droppedSpikes == 0;
+        ok = ok && same;
+        std::cout << std::setw(10) << tiles << " 进程" << std::setw(12) << r.fires << std::setw(12) << r.inducedFires
+                  << std::setw(12) << r.activeSynapses
+                  << std::setw(10) << r.droppedSpikes << std::setw(8) << (same ? "是" : "否") << std::endl;
+    }
+    std::cout << std::endl;
+    return ok;
+}
+
+static void print_row(const TiledSimulationConfig& config, const TiledSimulationResult& r, double baseline, bool weak) {
+    double speedup = baseline / r.seconds;
+    double efficiency = weak ? speedup : speedup / config.numTiles;
+    std::cout << std::setw(8) << config.numTiles << std::setw(12) << config.numNeurons
+              << std::setw(12) << std::fixed << std::setprecision(3) << r.seconds
+              << std::setw(10) << std::setprecision(2) << speedup
+              << std::setw(10) << efficiency
+              << std::setw(12) << r.remoteSpikes << std::setw(10) << r.droppedSpikes << std::setw(10) << r.migrations
+              << std::setw(8) << (r.totalNeurons == config.numNeurons ? "是" : "否") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int numNeurons = argc > 1 ? std::stoi(argv[1]) : 20000;
+    int steps = argc > 2 ? std::stoi(argv[2]) : 50;
+    int maxTiles = argc > 3 ? std::stoi(argv[3]) : 8;
+    SimulationParams params;
+    params.connectionThreshold = 30.0;
+    for (int i = 4; i < argc; ++i) {
+        if (!parse_simulation_param(params, argv[i])) {
+            std::cerr << "无法识别的参数: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    const double density = 1.0 / 400.0;  // 每400平方单位一个神经元
+
+    bool ok = check_consistency(maxTiles, params, density);
+
+    std::cout << "== 强扩展 (" << numNeurons << " 个神经元, " << steps << " 步) ==" << std::endl;
+    print_header();
+    double height = std::sqrt(numNeurons / density);
+    double baseline = 0;
+    for (int tiles = 1; tiles <= maxTiles; tiles *= 2) {
+        TiledSimulationConfig config{numNeurons, height, height, tiles, steps, 42, params};
+        TiledSimulationResult r = runTiledSimulation(config);
+        if (!r.ok) {
+            std::cerr << "工作进程异常退出" << std::endl;
+            return 1;
+        }
+        ok = ok && r.droppedSpikes == 0 && r.totalNeurons == config.numNeurons;
+        if (tiles == 1) baseline = r.seconds;
+        print_row(config, r, baseline, false);
+    }
+
+    int perTile = numNeurons / maxTiles;
+    std::cout << std::endl << "== 弱扩展 (每进程 " << perTile << " 个神经元) ==" << std::endl;
+    print_header();
+    double tileWidth = std::sqrt(perTile / density);
+    for (int tiles = 1; tiles <= maxTiles; tiles *= 2) {
+        TiledSimulationConfig config{perTile * tiles, tileWidth * tiles, tileWidth, tiles, steps, 42, params};
+        TiledSimulationResult r = runTiledSimulation(config);
+        if (!r.ok) {
+            std::cerr << "工作进程异常退出" << std::endl;
+            return 1;
+        }
+        ok = ok && r.droppedSpikes == 0 && r.totalNeurons == config.numNeurons;
+        if (tiles == 1) baseline = r.seconds;
+        print_row(config, r, baseline, true);
+    }
+    if (!ok) {
+        std::cout << "分块模拟与单进程结果不一致、丢弃了脉冲或神经元数不守恒" << std::endl;
+        return 1;
+    }
+    return 0;
+}
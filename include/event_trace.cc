@@ -0,0 +1,241 @@
+#include "event_trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// 文件格式：
+//   文件头: "NTRC" + uint32 版本号
+//   每个块: uint32 事件数, uint32 负载字节数, uint32 首个事件的步数, 负载
+//   负载中每个事件: varint(步数差) + 类型(1字节) + zigzag varint(神经元ID差)
+//                  [+ 突触事件: zigzag varint(目标ID - 神经元ID)] + uint16 量化的value（1/65535，截断到[0,1]）
+// 块之间互不依赖，截断的文件只丢失最后一个块。
+
+namespace {
+    const char TRACE_MAGIC[4] = {'N', 'T', 'R', 'C'};
+    const uint32_t TRACE_VERSION = 1;
+    const size_t CHUNK_EVENTS = 1 << 16;   // 每个块的事件数上限
+
+    void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    void put_zigzag(std::vector<uint8_t>& out, int64_t v) {
+        put_varint(out, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+
+    bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            uint8_t byte = *p++;
+            v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool get_zigzag(const uint8_t*& p, const uint8_t* end, int64_t& v) {
+        uint64_t u;
+        if (!get_varint(p, end, u)) return false;
+        v = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+        return true;
+    }
+
+    void put_u32(std::ofstream& file, uint32_t v) {
+        file.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    bool get_u32(std::ifstream& file, uint32_t& v) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&v), sizeof(v)));
+    }
+}
+
+const char* trace_event_name(TraceEventType type) {
+    switch (type) {
+        case TraceEventType::FIRE: return "fire";
+        case TraceEventType::SYNAPSE_CREATE: return "create";
+        case TraceEventType::SYNAPSE_STRENGTHEN: return "strengthen";
+        case TraceEventType::SYNAPSE_DEACTIVATE: return "deactivate";
+    }
+    return "unknown";
+}
+
+// TraceRing 实现
+TraceRing::TraceRing(size_t capacity) : head(0), tail(0) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+size_t TraceRing::drain(std::vector<TraceEvent>& out) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    for (size_t i = t; i != h; ++i) {
+        out.push_back(buffer[i & mask]);
+    }
+    tail.store(h, std::memory_order_release);
+    return h - t;
+}
+
+// TraceRecorder 实现
+TraceRecorder::TraceRecorder(const std::string& path, size_t ringCapacity)
+    : id(nextId.fetch_add(1)), path(path), ringCapacity(ringCapacity),
+      running(false), written(0), dropped(0), bytes(0) {}
+
+TraceRecorder::~TraceRecorder() {
+    stop();
+}
+
+bool TraceRecorder::start() {
+    if (writer.joinable()) return true;
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "无法创建追踪文件: " << path << std::endl;
+        return false;
+    }
+    file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    put_u32(file, TRACE_VERSION);
+    bytes = sizeof(TRACE_MAGIC) + sizeof(uint32_t);
+
+    running = true;
+    writer = std::thread(&TraceRecorder::writerLoop, this);
+    return true;
+}
+
+void TraceRecorder::stop() {
+    if (!writer.joinable()) return;
+    running = false;
+    writer.join();
+    file.close();
+}
+
+TraceRing* TraceRecorder::registerThread() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.push_back(std::make_unique<TraceRing>(ringCapacity));
+    return rings.back().get();
+}
+
+void TraceRecorder::writerLoop() {
+    std::vector<TraceEvent> chunk;
+    chunk.reserve(CHUNK_EVENTS * 2);
+    std::vector<TraceRing*> active;
+
+    while (true) {
+        // 先读取停止标志再排空，保证停止前写入的事件都被取走
+        bool stopping = !running.load();
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            active.clear();
+            for (const auto& ring : rings) active.push_back(ring.get());
+        }
+
+        size_t drained = 0;
+        for (TraceRing* ring : active) {
+            drained += ring->drain(chunk);
+        }
+        if (chunk.size() >= CHUNK_EVENTS || (stopping && !chunk.empty())) {
+            flushChunk(chunk);
+        }
+        if (stopping) break;
+        if (drained == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    file.flush();
+}
+
+void TraceRecorder::flushChunk(std::vector<TraceEvent>& chunk) {
+    // 多个线程的事件按步数归并，差分编码时步数差不为负
+    auto byStep = [](const TraceEvent& a, const TraceEvent& b) { return a.step < b.step; };
+    if (!std::is_sorted(chunk.begin(), chunk.end(), byStep)) {
+        std::stable_sort(chunk.begin(), chunk.end(), byStep);
+    }
+
+    std::vector<uint8_t> payload;
+    payload.reserve(chunk.size() * 6);
+    uint32_t prevStep = chunk.front().step;
+    int64_t prevNeuron = 0;
+    for (const auto& event : chunk) {
+        put_varint(payload, event.step - prevStep);
+        payload.push_back(static_cast<uint8_t>(event.type));
+        put_zigzag(payload, event.neuron - prevNeuron);
+        if (event.type != TraceEventType::FIRE) {
+            put_zigzag(payload, static_cast<int64_t>(event.target) - event.neuron);
+        }
+        float clamped = std::max(0.0f, std::min(1.0f, event.value));
+        uint16_t q = static_cast<uint16_t>(std::lround(clamped * 65535.0f));
+        payload.push_back(static_cast<uint8_t>(q));
+        payload.push_back(static_cast<uint8_t>(q >> 8));
+        prevStep = event.step;
+        prevNeuron = event.neuron;
+    }
+
+    put_u32(file, static_cast<uint32_t>(chunk.size()));
+    put_u32(file, static_cast<uint32_t>(payload.size()));
+    put_u32(file, chunk.front().step);
+    file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+    written += chunk.size();
+    bytes += 3 * sizeof(uint32_t) + payload.size();
+    chunk.clear();
+}
+
+// TraceReader 实现
+bool TraceReader::open(const std::string& path) {
+    file.open(path, std::ios::binary);
+    char magic[4];
+    uint32_t version;
+    if (!file || !file.read(magic, sizeof(magic)) || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 ||
+        !get_u32(file, version) || version != TRACE_VERSION) {
+        error = true;
+        return false;
+    }
+    return true;
+}
+
+bool TraceReader::nextChunk(std::vector<TraceEvent>& events) {
+    events.clear();
+    uint32_t count, size, step;
+    if (!get_u32(file, count)) return false;   // 正常结束
+    if (!get_u32(file, size) || !get_u32(file, step)) {
+        error = true;
+        return false;
+    }
+    payload.resize(size);
+    if (!file.read(reinterpret_cast<char*>(payload.data()), size)) {
+        error = true;
+        return false;
+    }
+
+    const uint8_t* p = payload.data();
+    const uint8_t* end = p + size;
+    int64_t neuron = 0;
+    events.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t stepDelta;
+        int64_t neuronDelta, targetDelta = 0;
+        if (!get_varint(p, end, stepDelta) || p >= end) break;
+        auto type = static_cast<TraceEventType>(*p++);
+        if (!get_zigzag(p, end, neuronDelta)) break;
+        if (type != TraceEventType::FIRE && !get_zigzag(p, end, targetDelta)) break;
+        if (end - p < 2) break;
+        uint16_t q = static_cast<uint16_t>(p[0] | (p[1] << 8));
+        p += 2;
+
+        step += static_cast<uint32_t>(stepDelta);
+        neuron += neuronDelta;
+        int32_t target = type == TraceEventType::FIRE ? -1 : static_cast<int32_t>(neuron + targetDelta);
+        events.push_back({step, static_cast<int32_t>(neuron), target, q / 65535.0f, type});
+    }
+    if (events.size() != count) {
+        error = true;
+        return false;
+    }
+    return true;
+}
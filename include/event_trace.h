@@ -0,0 +1,130 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 脉冲和突触事件的二进制追踪：
+// 模拟线程把定长事件写入本线程独占的无锁环形缓冲区（满时丢弃并计数，不阻塞），
+// 后台写线程汇总各缓冲区，按块做差分+变长整数编码后写入文件。
+
+enum class TraceEventType : uint8_t {
+    FIRE = 0,                // 神经元发放（value为激活水平）
+    SYNAPSE_CREATE = 1,      // 建立突触（value为初始强度）
+    SYNAPSE_STRENGTHEN = 2,  // 突触增强（value为增强后的强度）
+    SYNAPSE_DEACTIVATE = 3   // 突触失活（value为失活时的强度）
+};
+
+const int TRACE_EVENT_TYPES = 4;
+const char* trace_event_name(TraceEventType type);
+
+// 一个事件；neuron/target 为神经元外部ID，FIRE 事件的 target 为 -1
+struct TraceEvent {
+    uint32_t step;
+    int32_t neuron;
+    int32_t target;
+    float value;
+    TraceEventType type;
+};
+
+// 单生产者/单消费者环形缓冲区，容量为2的幂
+class TraceRing {
+public:
+    explicit TraceRing(size_t capacity);
+
+    // 生产者：写入一个事件，缓冲区满时返回false
+    bool push(const TraceEvent& event) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == buffer.size()) return false;
+        buffer[h & mask] = event;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：取出当前所有事件追加到 out，返回取出的数量
+    size_t drain(std::vector<TraceEvent>& out);
+
+private:
+    std::vector<TraceEvent> buffer;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+// 追踪记录器：可被多个线程同时写入，每个线程首次写入时分配自己的环形缓冲区
+class TraceRecorder {
+public:
+    explicit TraceRecorder(const std::string& path, size_t ringCapacity = 1 << 18);
+    ~TraceRecorder();
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // 打开输出文件并启动写线程，失败时返回false
+    bool start();
+    // 写完所有缓冲区中的事件并关闭文件
+    void stop();
+
+    void record(uint32_t step, int32_t neuron, TraceEventType type, int32_t target, float value) {
+        ThreadCache& cache = threadCache;
+        if (cache.owner != id) {
+            cache.ring = registerThread();
+            cache.owner = id;
+        }
+        if (!cache.ring->push({step, neuron, target, value, type})) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t getWritten() const { return written.load(); }
+    uint64_t getDropped() const { return dropped.load(); }
+    uint64_t getBytes() const { return bytes.load(); }
+
+private:
+    // 线程局部存储零初始化，owner 为0表示尚未登记
+    struct ThreadCache {
+        uint64_t owner;
+        TraceRing* ring;
+    };
+    inline static thread_local ThreadCache threadCache;
+    inline static std::atomic<uint64_t> nextId{1};
+
+    TraceRing* registerThread();
+    void writerLoop();
+    void flushChunk(std::vector<TraceEvent>& chunk);
+
+    const uint64_t id;   // 区分记录器实例，线程缓存按它判断是否属于当前记录器
+    std::string path;
+    size_t ringCapacity;
+    std::ofstream file;
+
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    std::thread writer;
+    std::atomic<bool> running;
+
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> bytes;
+};
+
+// 顺序读取追踪文件，每次解码一个块
+class TraceReader {
+public:
+    bool open(const std::string& path);
+    // 读取下一个块的事件（覆盖 events），文件结束或格式错误时返回false
+    bool nextChunk(std::vector<TraceEvent>& events);
+    bool failed() const { return error; }
+
+private:
+    std::ifstream file;
+    std::vector<uint8_t> payload;
+    bool error = false;
+};
+
+#endif // EVENT_TRACE_H
@@ -0,0 +1,187 @@
+#include "frame_export.h"
+#include "network_renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+FrameExporter::FrameExporter(FrameOutput output, const std::string& path, int width, int height,
+                             int every, size_t queueCapacity)
+    : output(output), path(path), width(width), height(height), every(every > 0 ? every : 1),
+      fd(-1), stopping(false), outputClosed(false) {
+    for (size_t i = 0; i < std::max<size_t>(1, queueCapacity); ++i) {
+        slots.push_back(std::make_unique<RenderSnapshot>());
+        freeSlots.push_back(slots.back().get());
+    }
+}
+
+FrameExporter::~FrameExporter() {
+    finish();
+}
+
+bool FrameExporter::start() {
+    if (encoder.joinable()) return true;
+
+    if (output == FrameOutput::PNG_SEQUENCE) {
+        std::error_code ec;
+        std::filesystem::create_directories(path, ec);
+        if (ec) {
+            std::cerr << "无法创建录制目录: " << path << std::endl;
+            return false;
+        }
+    } else {
+        // 命名管道在读端打开之前会阻塞在这里，而不是在模拟过程中
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "无法打开录制输出: " << path << std::endl;
+            return false;
+        }
+    }
+
+    stopping = false;
+    outputClosed = false;
+    encoder = std::thread(&FrameExporter::encoderLoop, this);
+    return true;
+}
+
+static double ms_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FrameExporter::onStep(const NeuralNetworkSimulation& sim) {
+    if (!encoder.joinable() || sim.currentStep % every != 0) return;
+
+    auto begin = std::chrono::steady_clock::now();
+    RenderSnapshot* slot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (outputClosed) return;
+        if (freeSlots.empty()) {
+            stats.dropped++;
+            stats.maxStallMs = std::max(stats.maxStallMs, ms_since(begin));
+            return;
+        }
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+
+    // 复制在锁外进行；编码只需要绘制，不需要悬停索引
+    auto start = std::chrono::steady_clock::now();
+    slot->capture(sim, false);
+    double ms = ms_since(start);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(slot);
+        stats.captured++;
+        stats.captureMs += ms;
+        stats.maxStallMs = std::max(stats.maxStallMs, ms_since(begin));
+    }
+    ready.notify_one();
+}
+
+void FrameExporter::finish() {
+    if (!encoder.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    encoder.join();
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+FrameExportStats FrameExporter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void FrameExporter::encoderLoop() {
+    // 读端（如 ffmpeg）提前退出时 write() 会向写入线程发送 SIGPIPE，默认处理会终止整个训练进程。
+    // 在编码线程中屏蔽它，write() 改为返回 EPIPE，由 writeFrame 停止导出
+    sigset_t pipeSignal;
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+
+    NetworkRenderer renderer;
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t* cr = cairo_create(surface);
+
+    while (true) {
+        RenderSnapshot* slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) break;
+            slot = pending.front();
+            pending.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        renderer.render(cr, *slot, width, height, nullptr);
+
+        // 左上角标注模拟步数
+        char label[32];
+        std::snprintf(label, sizeof(label), "第 %d 步", slot->step);
+        cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
+        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+        cairo_set_font_size(cr, 13.0);
+        cairo_move_to(cr, 10, 20);
+        cairo_show_text(cr, label);
+        cairo_surface_flush(surface);
+
+        bool ok = writeFrame(*slot, surface);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        freeSlots.push_back(slot);
+        if (ok) stats.written++;
+        stats.encodeMs += ms;
+        if (outputClosed) break;
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+bool FrameExporter::writeFrame(const RenderSnapshot& snapshot, cairo_surface_t* surface) {
+    if (output == FrameOutput::PNG_SEQUENCE) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%06d.png", snapshot.step);
+        std::string file = (std::filesystem::path(path) / name).string();
+        return cairo_surface_write_to_png(surface, file.c_str()) == CAIRO_STATUS_SUCCESS;
+    }
+
+    // 原始帧逐行写出，去掉行尾填充
+    const unsigned char* data = cairo_image_surface_get_data(surface);
+    const int stride = cairo_image_surface_get_stride(surface);
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = data + static_cast<size_t>(y) * stride;
+        size_t done = 0;
+        while (done < rowBytes) {
+            ssize_t n = write(fd, row + done, rowBytes - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno == EPIPE) {
+                // 读端已关闭，之后的帧不再录制，模拟照常继续
+                std::cerr << "录制输出的读端已关闭，停止导出帧: " << path << std::endl;
+                std::lock_guard<std::mutex> lock(mutex);
+                outputClosed = true;
+                return false;
+            }
+            if (n <= 0) return false;
+            done += n;
+        }
+    }
+    return true;
+}
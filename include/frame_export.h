@@ -0,0 +1,78 @@
+#ifndef FRAME_EXPORT_H
+#define FRAME_EXPORT_H
+
+#include <cairo.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "neuron_sim.h"
+#include "render_snapshot.h"
+
+// 离屏帧导出的输出方式
+enum class FrameOutput {
+    PNG_SEQUENCE,   // 目录下的 frame_000000.png 序列（文件名为模拟步数）
+    RAW_STREAM      // 向文件或命名管道连续写入原始帧（cairo ARGB32，小端即 BGRA，无填充）
+};
+
+// 导出统计
+struct FrameExportStats {
+    long captured = 0;          // 模拟线程复制出的快照数
+    long written = 0;           // 编码线程写出的帧数
+    long dropped = 0;           // 队列满时丢弃的帧数
+    double captureMs = 0;       // 模拟线程上花在复制快照上的总时间
+    double maxStallMs = 0;      // 单次 onStep() 让模拟线程停下的最长时间（含等锁和复制）
+    double encodeMs = 0;        // 编码线程上渲染+写出的总时间
+};
+
+// 无窗口地把模拟录制成帧序列（用于没有显示器的服务器）。
+//
+// 模拟线程每 every 步复制一份 RenderSnapshot 放入有界队列，后台编码线程用 NetworkRenderer
+// 绘制到 cairo 图像表面后写出。快照槽位预先分配并循环使用；队列满时丢弃当前帧而不是等待，
+// 所以模拟线程不会等待 PNG 压缩或磁盘：它在 onStep() 中只复制快照，并两次短暂加锁
+// （与编码线程取放槽位争用，见 FrameExportStats::maxStallMs）。但编码线程本身要占用CPU，
+// 没有空闲的核时它仍与模拟线程分时运行，整体步速会下降
+class FrameExporter {
+public:
+    FrameExporter(FrameOutput output, const std::string& path, int width, int height,
+                  int every = 10, size_t queueCapacity = 4);
+    ~FrameExporter();
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    // 创建输出目录或打开输出文件并启动编码线程，失败时返回false
+    bool start();
+
+    // 在每个模拟步之后调用，步数是 every 的倍数时录制一帧
+    void onStep(const NeuralNetworkSimulation& sim);
+
+    // 写完队列中剩余的帧并停止编码线程
+    void finish();
+
+    FrameExportStats getStats() const;
+
+private:
+    void encoderLoop();
+    bool writeFrame(const RenderSnapshot& snapshot, cairo_surface_t* surface);
+
+    FrameOutput output;
+    std::string path;
+    int width, height;
+    int every;
+    int fd;
+
+    std::vector<std::unique_ptr<RenderSnapshot>> slots;
+    std::vector<RenderSnapshot*> freeSlots;      // 可供模拟线程写入的槽位
+    std::deque<RenderSnapshot*> pending;         // 等待编码的槽位（按步数顺序）
+    mutable std::mutex mutex;
+    std::condition_variable ready;
+    bool stopping;
+    bool outputClosed;                           // 管道读端已关闭，不再录制
+    std::thread encoder;
+    FrameExportStats stats;
+};
+
+#endif // FRAME_EXPORT_H
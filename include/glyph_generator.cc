@@ -0,0 +1,165 @@
+#include "glyph_generator.h"
+#include "img_char_number.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "stb_truetype.h"
+
+namespace fs = std::filesystem;
+
+// 原型按目标尺寸的4倍栅格化，缩小时仍有足够的细节
+static const int PROTOTYPE_OVERSAMPLE = 4;
+// generation.py 在 200x200 图片上使用 120 像素字号
+static const double FONT_SIZE_RATIO = 120.0 / 200.0;
+// 噪声查找表大小（2的幂，用随机数的低16位索引）
+static const size_t GAUSSIAN_TABLE_SIZE = 1 << 16;
+
+GlyphGenerator::GlyphGenerator(const std::vector<std::string>& fontPaths, uint64_t seed, const GlyphAugment& augment)
+    : augment(augment), rng(static_cast<std::mt19937::result_type>(seed)) {
+    const float emPixels = static_cast<float>(FONT_SIZE_RATIO * DIGIT_INPUT_HEIGHT * PROTOTYPE_OVERSAMPLE);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    gaussianTable.resize(GAUSSIAN_TABLE_SIZE);
+    for (auto& value : gaussianTable) value = normal(rng);
+
+    for (const auto& path : fontPaths) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.empty()) continue;
+
+        stbtt_fontinfo info;
+        int offset = stbtt_GetFontOffsetForIndex(data.data(), 0);
+        if (offset < 0 || !stbtt_InitFont(&info, data.data(), offset)) continue;
+        // 与PIL的字号相同，按em方框缩放
+        float scale = stbtt_ScaleForMappingEmToPixels(&info, emPixels);
+
+        std::vector<Prototype> glyphs;
+        for (int digit = 0; digit < DIGIT_COUNT; ++digit) {
+            int codepoint = '0' + digit;
+            if (stbtt_FindGlyphIndex(&info, codepoint) == 0) break;
+
+            int width = 0, height = 0, xoff = 0, yoff = 0;
+            unsigned char* bitmap = stbtt_GetCodepointBitmap(&info, scale, scale, codepoint,
+                                                             &width, &height, &xoff, &yoff);
+            if (!bitmap) break;
+            Prototype proto;
+            proto.width = width;
+            proto.height = height;
+            proto.pixelsPerTarget = PROTOTYPE_OVERSAMPLE;
+            proto.coverage.resize(static_cast<size_t>(width) * height);
+            for (size_t i = 0; i < proto.coverage.size(); ++i) {
+                proto.coverage[i] = bitmap[i] / 255.0f;
+            }
+            stbtt_FreeBitmap(bitmap, nullptr);
+            if (width <= 0 || height <= 0) break;
+            glyphs.push_back(std::move(proto));
+        }
+
+        // 只使用十个数字都有字形的字体
+        if (glyphs.size() == static_cast<size_t>(DIGIT_COUNT)) {
+            for (auto& proto : glyphs) prototypes.push_back(std::move(proto));
+            fontCount++;
+        }
+    }
+}
+
+float GlyphGenerator::sampleBilinear(const Prototype& proto, double x, double y) const {
+    double fx = std::floor(x), fy = std::floor(y);
+    int x0 = static_cast<int>(fx), y0 = static_cast<int>(fy);
+    float ax = static_cast<float>(x - fx), ay = static_cast<float>(y - fy);
+    auto at = [&proto](int px, int py) -> float {
+        if (px < 0 || py < 0 || px >= proto.width || py >= proto.height) return 0.0f;
+        return proto.coverage[static_cast<size_t>(py) * proto.width + px];
+    };
+    float top = at(x0, y0) * (1 - ax) + at(x0 + 1, y0) * ax;
+    float bottom = at(x0, y0 + 1) * (1 - ax) + at(x0 + 1, y0 + 1) * ax;
+    return top * (1 - ay) + bottom * ay;
+}
+
+std::vector<std::vector<double>> GlyphGenerator::generate(int digit) {
+    std::vector<std::vector<double>> img;
+    generate(digit, img);
+    return img;
+}
+
+void GlyphGenerator::generate(int digit, std::vector<std::vector<double>>& out) {
+    if (out.size() != static_cast<size_t>(DIGIT_INPUT_HEIGHT)) {
+        out.assign(DIGIT_INPUT_HEIGHT, std::vector<double>(DIGIT_INPUT_WIDTH, 0.0));
+    }
+    for (auto& row : out) row.assign(DIGIT_INPUT_WIDTH, 0.0);
+    if (fontCount == 0 || digit < 0 || digit >= DIGIT_COUNT) return;
+
+    std::uniform_int_distribution<size_t> fontDist(0, fontCount - 1);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    const Prototype& proto = prototypes[fontDist(rng) * DIGIT_COUNT + digit];
+
+    // 正向变换：输出 = 中心 + 平移 + 旋转 * 错切 * 缩放 * 原型坐标 / 过采样倍数。
+    // 对每个输出像素用逆变换求出原型中的位置：M = 过采样倍数 / 缩放 * 错切^-1 * 旋转^-1
+    const double angle = unit(rng) * augment.maxRotation * M_PI / 180.0;
+    const double scale = 1.0 + unit(rng) * augment.maxScale;
+    const double shear = unit(rng) * augment.maxShear;
+    const double shiftX = unit(rng) * augment.maxShift;
+    const double shiftY = unit(rng) * augment.maxShift;
+    const double c = std::cos(angle), s = std::sin(angle), k = proto.pixelsPerTarget / scale;
+    const double m00 = k * (c + shear * s), m01 = k * (s - shear * c);
+    const double m10 = k * -s, m11 = k * c;
+    const double centerX = DIGIT_INPUT_WIDTH / 2.0 + shiftX, centerY = DIGIT_INPUT_HEIGHT / 2.0 + shiftY;
+    const double protoX = proto.width / 2.0 - 0.5, protoY = proto.height / 2.0 - 0.5;
+
+    // 每个像素取一个32位随机数：低16位索引噪声表，高16位与翻转概率比较
+    const uint32_t flipThreshold = static_cast<uint32_t>(std::max(0.0, std::min(1.0, augment.flipChance)) * 65536.0);
+    // 一个输出像素在原型中覆盖的半径，像素中心落在原型外超过该距离时整个像素都是背景
+    const double reach = 0.5 * (std::abs(m00) + std::abs(m01) + std::abs(m10) + std::abs(m11)) + 1.0;
+    for (int y = 0; y < DIGIT_INPUT_HEIGHT; ++y) {
+        for (int x = 0; x < DIGIT_INPUT_WIDTH; ++x) {
+            double value = 0.0;
+            double cx = x + 0.5 - centerX, cy = y + 0.5 - centerY;
+            double u = m00 * cx + m01 * cy + protoX, v = m10 * cx + m11 * cy + protoY;
+            if (u > -reach && v > -reach && u < proto.width + reach && v < proto.height + reach) {
+                // 在 2x2 个子位置采样取平均，避免缩小时的锯齿
+                for (double sy : {-0.25, 0.25}) {
+                    for (double sx : {-0.25, 0.25}) {
+                        value += sampleBilinear(proto, u + m00 * sx + m01 * sy, v + m10 * sx + m11 * sy);
+                    }
+                }
+                value /= 4.0;
+            }
+            uint32_t bits = rng();
+            value += augment.noise * gaussianTable[bits & (GAUSSIAN_TABLE_SIZE - 1)];
+            if ((bits >> 16) < flipThreshold) value = 1.0 - value;
+            out[y][x] = std::max(0.0, std::min(1.0, value));
+        }
+    }
+}
+
+std::vector<std::string> list_font_files(const std::vector<std::string>& dirs) {
+    std::vector<std::string> roots = dirs;
+    if (roots.empty()) {
+        roots.push_back("/usr/share/fonts");
+        if (const char* home = std::getenv("HOME")) {
+            roots.push_back(std::string(home) + "/.local/share/fonts");
+            roots.push_back(std::string(home) + "/.fonts");
+        }
+    }
+
+    std::vector<std::string> fonts;
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (!fs::is_directory(root, ec)) continue;
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+             it != end; it.increment(ec)) {
+            if (ec) break;
+            std::string ext = it->path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (it->is_regular_file(ec) && (ext == ".ttf" || ext == ".otf" || ext == ".ttc")) {
+                fonts.push_back(it->path().string());
+            }
+        }
+    }
+    std::sort(fonts.begin(), fonts.end());
+    fonts.erase(std::unique(fonts.begin(), fonts.end()), fonts.end());
+    return fonts;
+}
@@ -0,0 +1,64 @@
+#ifndef GLYPH_GENERATOR_H
+#define GLYPH_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+
+// 随机增强的幅度，每个样本在 [-max, max] 内均匀抽取
+struct GlyphAugment {
+    double maxRotation = 10.0;   // 旋转角度（度）
+    double maxScale = 0.10;      // 缩放比例的偏离，1 ± maxScale
+    double maxShear = 0.15;      // 水平错切系数
+    double maxShift = 2.0;       // 平移（像素）
+    double noise = 0.05;         // 每个像素叠加的高斯噪声标准差
+    double flipChance = 0.01;    // 每个像素被翻转（墨迹 <-> 背景）的概率
+};
+
+// 进程内的数字样本生成器：用 stb_truetype 从字体文件栅格化 0-9，
+// 在内存中做随机仿射变换和噪声增强，直接输出与 load_png_image 相同格式的
+// 28x28 灰度图（1 为墨迹，0 为背景），训练时无需读写磁盘。
+//
+// 每个字体的每个数字只在构造时栅格化一次（高分辨率原型），
+// 生成样本时用逆仿射变换对原型双线性采样，每张图片只处理 28x28 个像素。
+// 数字大小和居中方式与 generation.py 一致（字号为图片高度的 60%，按墨迹边界框居中）。
+// 每个生成器带有自己的随机数状态，多线程时每个线程使用自己的生成器。
+class GlyphGenerator {
+public:
+    // fontPaths 中无法加载或缺少数字字形的字体被跳过
+    GlyphGenerator(const std::vector<std::string>& fontPaths, uint64_t seed = 1,
+                   const GlyphAugment& augment = GlyphAugment());
+
+    // 可用的字体数量，为0时无法生成样本
+    size_t getFontCount() const { return fontCount; }
+
+    // 生成一张指定数字的样本，字体随机选择
+    std::vector<std::vector<double>> generate(int digit);
+
+    // 生成一张样本写入 out（复用已有的存储，热循环中不分配内存）
+    void generate(int digit, std::vector<std::vector<double>>& out);
+
+private:
+    // 一个字体中一个数字的原型位图（覆盖率 0-1），原点为墨迹边界框中心
+    struct Prototype {
+        std::vector<float> coverage;
+        int width = 0, height = 0;
+        double pixelsPerTarget = 1.0;   // 原型像素 / 目标图片像素
+    };
+
+    float sampleBilinear(const Prototype& proto, double x, double y) const;
+
+    std::vector<Prototype> prototypes;   // [字体 * DIGIT_COUNT + 数字]
+    // 预先抽取的标准正态分布值，逐像素噪声查表而不是每个像素调用一次正态分布
+    std::vector<float> gaussianTable;
+    size_t fontCount = 0;
+    GlyphAugment augment;
+    std::mt19937 rng;
+};
+
+// 在 generation.py 使用的系统字体目录（/usr/share/fonts、~/.local/share/fonts、~/.fonts）
+// 或指定目录下递归查找 stb_truetype 可读的字体（.ttf/.otf/.ttc），按路径排序
+std::vector<std::string> list_font_files(const std::vector<std::string>& dirs = {});
+
+#endif // GLYPH_GENERATOR_H
@@ -0,0 +1,482 @@
+#include "img_char_number.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace fs = std::filesystem;
+
+// 加载PNG图片并转换为灰度值（0-1）
+std::vector<std::vector<double>> load_png_image(const std::string& path, int target_width, int target_height) {
+    std::vector<std::vector<double>> img;
+    int width, height, channels;
+
+    // 加载图片（自动转换为灰度图）
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 1);
+    if (!data) {
+        std::cerr << "无法加载图片: " << path << " (" << stbi_failure_reason() << ")" << std::endl;
+        return img;
+    }
+
+    // 缩放图片到目标尺寸（最近邻缩放）
+    img.resize(target_height, std::vector<double>(target_width, 0.0));
+    double x_ratio = static_cast<double>(width) / target_width;
+    double y_ratio = static_cast<double>(height) / target_height;
+
+    for (int y = 0; y < target_height; ++y) {
+        for (int x = 0; x < target_width; ++x) {
+            int src_x = static_cast<int>(x * x_ratio);
+            int src_y = static_cast<int>(y * y_ratio);
+            int idx = src_y * width + src_x;
+            // 反转颜色（假设黑色背景白色数字）
+            img[y][x] = 1.0 - (static_cast<double>(data[idx]) / 255.0);
+        }
+    }
+
+    stbi_image_free(data);
+    return img;
+}
+
+// 模型文件尾：4字节标记 + int32 TrainingData。load_training_result 只读取突触表，不受文件尾影响
+static const char TRAINING_DATA_MAGIC[4] = {'N', 'T', 'R', 'D'};
+
+// 保存训练结果
+bool save_training_result(const NeuralNetworkSimulation& sim, const std::string& path, TrainingData data) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "无法打开文件保存训练结果: " << path << std::endl;
+        return false;
+    }
+
+    // 保存神经元数量
+    size_t num_neurons = sim.neurons.size();
+    file.write(reinterpret_cast<const char*>(&num_neurons), sizeof(num_neurons));
+
+    // 按外部ID顺序保存每个神经元的连接信息（目标同样记为外部ID，与内存中的排列无关）
+    for (size_t id = 0; id < num_neurons; ++id) {
+        const auto& synapses = sim.neuronById(id).getActiveSynapses();
+        size_t num_synapses = synapses.size();
+        file.write(reinterpret_cast<const char*>(&num_synapses), sizeof(num_synapses));
+
+        for (const auto& synapse : synapses) {
+            int target = sim.idOf(synapse.targetNeuron);
+            file.write(reinterpret_cast<const char*>(&target), sizeof(target));
+            file.write(reinterpret_cast<const char*>(&synapse.strength), sizeof(synapse.strength));
+            file.write(reinterpret_cast<const char*>(&synapse.lastUsed), sizeof(synapse.lastUsed));
+        }
+    }
+
+    int32_t dataTag = static_cast<int32_t>(data);
+    file.write(TRAINING_DATA_MAGIC, sizeof(TRAINING_DATA_MAGIC));
+    file.write(reinterpret_cast<const char*>(&dataTag), sizeof(dataTag));
+    return file.good();
+}
+
+TrainingData read_training_data(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    int32_t dataTag = 0;
+    const std::streamoff trailer = sizeof(magic) + sizeof(dataTag);
+    if (!file.is_open() || !file.seekg(-trailer, std::ios::end)) return TrainingData::UNKNOWN;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&dataTag), sizeof(dataTag));
+    if (!file || !std::equal(magic, magic + 4, TRAINING_DATA_MAGIC) ||
+        dataTag < static_cast<int32_t>(TrainingData::UNKNOWN) || dataTag > static_cast<int32_t>(TrainingData::SYNTHETIC)) {
+        return TrainingData::UNKNOWN;
+    }
+    return static_cast<TrainingData>(dataTag);
+}
+
+// 加载训练结果
+bool load_training_result(NeuralNetworkSimulation& sim, const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "无法打开训练结果文件: " << path << std::endl;
+        return false;
+    }
+
+    // 读取神经元数量
+    size_t num_neurons;
+    file.read(reinterpret_cast<char*>(&num_neurons), sizeof(num_neurons));
+
+    // 重新初始化神经元网络
+    sim = NeuralNetworkSimulation(num_neurons, sim.width, sim.height, sim.params);
+
+    // 读取每个神经元的连接信息
+    for (size_t i = 0; i < num_neurons; ++i) {
+        size_t num_synapses;
+        file.read(reinterpret_cast<char*>(&num_synapses), sizeof(num_synapses));
+
+        for (size_t j = 0; j < num_synapses; ++j) {
+            int target;
+            double strength, last_used;
+            file.read(reinterpret_cast<char*>(&target), sizeof(target));
+            file.read(reinterpret_cast<char*>(&strength), sizeof(strength));
+            file.read(reinterpret_cast<char*>(&last_used), sizeof(last_used));
+
+            sim.connect(static_cast<int>(i), target, strength, last_used);
+        }
+    }
+
+    return true;
+}
+
+void train_on_image(NeuralNetworkSimulation& sim, const std::vector<std::vector<double>>& img, int digit,
+                    bool showProgress, const std::function<void(const NeuralNetworkSimulation&)>& afterStep) {
+    // 激活输入层神经元（前28*28个神经元）
+    for (int y = 0; y < DIGIT_INPUT_HEIGHT; ++y) {
+        for (int x = 0; x < DIGIT_INPUT_WIDTH; ++x) {
+            int neuron_idx = y * DIGIT_INPUT_WIDTH + x;
+            if (img[y][x] > 0.5 && neuron_idx < static_cast<int>(sim.neurons.size())) {
+                sim.stimulate(neuron_idx);
+            }
+        }
+    }
+
+    // 激活对应数字的输出神经元（最后10个神经元）
+    int output_neuron = DIGIT_INPUT_WIDTH * DIGIT_INPUT_HEIGHT + digit;
+    if (output_neuron < static_cast<int>(sim.neurons.size())) {
+        sim.stimulate(output_neuron);
+    }
+
+    // 运行训练步骤
+    const int steps = sim.params.trainSteps;
+    for (int step = 0; step < steps; ++step) {
+        sim.step();
+        if (afterStep) afterStep(sim);
+        if (showProgress && step % 100 == 0) {
+            std::cout << "\r训练进度: " << (step * 100 / steps) << "% " << std::flush;
+        }
+    }
+    if (showProgress) {
+        std::cout << "\r训练进度: 100% 完成" << std::endl;
+    }
+}
+
+// 识别图片中的数字
+int recognize_digit(NeuralNetworkSimulation& sim, const std::vector<std::vector<double>>& img) {
+    const int INPUT_WIDTH = img[0].size();
+    const int INPUT_HEIGHT = img.size();
+
+    // 激活输入层神经元
+    for (int y = 0; y < INPUT_HEIGHT; ++y) {
+        for (int x = 0; x < INPUT_WIDTH; ++x) {
+            int neuron_idx = y * INPUT_WIDTH + x;
+            if (img[y][x] > 0.5 && neuron_idx < static_cast<int>(sim.neurons.size())) {
+                sim.stimulate(neuron_idx);
+            }
+        }
+    }
+
+    // 运行识别步骤
+    for (int step = 0; step < DIGIT_RECOGNIZE_STEPS; ++step) {
+        sim.step();
+    }
+
+    // 检查输出层神经元激活情况（最后10个神经元）
+    std::vector<double> activation_levels(DIGIT_COUNT, 0.0);
+    int output_start = sim.neurons.size() - DIGIT_COUNT;
+
+    for (int i = 0; i < DIGIT_COUNT; ++i) {
+        if (output_start + i < static_cast<int>(sim.neurons.size())) {
+            activation_levels[i] = sim.neuronById(output_start + i).getActivationLevel();
+        }
+    }
+
+    // 返回激活水平最高的数字
+    return std::distance(activation_levels.begin(),
+                        std::max_element(activation_levels.begin(), activation_levels.end()));
+}
+
+std::vector<DigitSample> list_digit_samples(const std::string& root) {
+    std::vector<DigitSample> samples;
+    for (int digit = 0; digit < DIGIT_COUNT; ++digit) {
+        std::string dir = root + "/" + std::to_string(digit);
+        if (!fs::exists(dir)) continue;
+
+        std::vector<std::string> paths;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.path().extension() == ".png") {
+                paths.push_back(entry.path().string());
+            }
+        }
+        // 按文件名的自然顺序排序（2.png 在 10.png 之前），保证划分稳定
+        std::sort(paths.begin(), paths.end(), [](const std::string& a, const std::string& b) {
+            return a.size() != b.size() ? a.size() < b.size() : a < b;
+        });
+        for (auto& path : paths) {
+            samples.push_back({std::move(path), digit});
+        }
+    }
+    return samples;
+}
+
+void split_digit_samples(const std::vector<DigitSample>& all,
+                         std::vector<DigitSample>& train, std::vector<DigitSample>& holdout) {
+    std::vector<size_t> seen(DIGIT_COUNT, 0);
+    for (const auto& sample : all) {
+        if (seen[sample.digit]++ % 5 == 0) {
+            holdout.push_back(sample);
+        } else {
+            train.push_back(sample);
+        }
+    }
+}
+
+std::vector<DigitImage> load_digit_images(const std::vector<DigitSample>& samples, size_t perDigit) {
+    std::vector<DigitImage> images;
+    std::vector<size_t> count(DIGIT_COUNT, 0);
+    for (const auto& sample : samples) {
+        if (perDigit > 0 && count[sample.digit] >= perDigit) continue;
+        auto img = load_png_image(sample.path, DIGIT_INPUT_WIDTH, DIGIT_INPUT_HEIGHT);
+        if (img.empty()) continue;
+        count[sample.digit]++;
+        images.push_back({std::move(img), sample.digit});
+    }
+    return images;
+}
+
+static const char DIGIT_PACK_MAGIC[4] = {'N', 'D', 'P', 'K'};
+
+bool save_digit_pack(const std::vector<DigitImage>& images, const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "无法打开文件保存数据集: " << path << std::endl;
+        return false;
+    }
+
+    uint32_t header[3] = {static_cast<uint32_t>(images.size()), DIGIT_INPUT_WIDTH, DIGIT_INPUT_HEIGHT};
+    file.write(DIGIT_PACK_MAGIC, sizeof(DIGIT_PACK_MAGIC));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    std::vector<uint8_t> record(1 + DIGIT_INPUT_WIDTH * DIGIT_INPUT_HEIGHT, 0);
+    for (const auto& image : images) {
+        record[0] = static_cast<uint8_t>(image.digit);
+        for (int y = 0; y < DIGIT_INPUT_HEIGHT; ++y) {
+            for (int x = 0; x < DIGIT_INPUT_WIDTH; ++x) {
+                double v = y < static_cast<int>(image.img.size()) && x < static_cast<int>(image.img[y].size())
+                               ? image.img[y][x] : 0.0;
+                record[1 + y * DIGIT_INPUT_WIDTH + x] =
+                    static_cast<uint8_t>(std::lround(std::max(0.0, std::min(1.0, v)) * 255.0));
+            }
+        }
+        file.write(reinterpret_cast<const char*>(record.data()), record.size());
+    }
+    return file.good();
+}
+
+bool load_digit_pack(std::vector<DigitImage>& images, const std::string& path) {
+    images.clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "无法打开数据集文件: " << path << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t header[3];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || !std::equal(magic, magic + 4, DIGIT_PACK_MAGIC) ||
+        header[1] != DIGIT_INPUT_WIDTH || header[2] != DIGIT_INPUT_HEIGHT) {
+        std::cerr << "数据集文件格式不正确: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> record(1 + DIGIT_INPUT_WIDTH * DIGIT_INPUT_HEIGHT);
+    images.reserve(header[0]);
+    for (uint32_t i = 0; i < header[0]; ++i) {
+        if (!file.read(reinterpret_cast<char*>(record.data()), record.size()) || record[0] >= DIGIT_COUNT) {
+            std::cerr << "数据集文件损坏或被截断: " << path << std::endl;
+            images.clear();
+            return false;
+        }
+        DigitImage image{std::vector<std::vector<double>>(DIGIT_INPUT_HEIGHT, std::vector<double>(DIGIT_INPUT_WIDTH)),
+                         record[0]};
+        for (int y = 0; y < DIGIT_INPUT_HEIGHT; ++y) {
+            for (int x = 0; x < DIGIT_INPUT_WIDTH; ++x) {
+                image.img[y][x] = record[1 + y * DIGIT_INPUT_WIDTH + x] / 255.0;
+            }
+        }
+        images.push_back(std::move(image));
+    }
+    return true;
+}
+
+void merge_synapses(NeuralNetworkSimulation& master, const std::vector<NeuralNetworkSimulation>& replicas,
+                    SynapseMergeMode mode) {
+    struct Merged {
+        double strength;
+        double lastUsed;
+        int count;
+    };
+    const size_t n = master.neurons.size();
+    for (const auto& replica : replicas) {
+        master.currentStep = std::max(master.currentStep, replica.currentStep);
+    }
+    std::vector<Merged> byTarget(n, Merged{0.0, 0.0, 0});   // 以目标外部ID为下标
+    std::vector<int> touched;
+    std::vector<Synapse> synapses;
+
+    for (size_t id = 0; id < n; ++id) {
+        for (const auto& replica : replicas) {
+            for (const auto& synapse : replica.neuronById(id).getSynapses()) {
+                if (!synapse.isActive) continue;
+                int target = replica.idOf(synapse.targetNeuron);
+                Merged& m = byTarget[target];
+                if (m.count == 0) {
+                    m = {synapse.strength, synapse.lastUsed, 1};
+                    touched.push_back(target);
+                    continue;
+                }
+                m.strength = mode == SynapseMergeMode::MAX ? std::max(m.strength, synapse.strength)
+                                                           : m.strength + synapse.strength;
+                m.lastUsed = std::max(m.lastUsed, synapse.lastUsed);
+                m.count++;
+            }
+        }
+
+        // 按目标ID排序，合并结果与副本的遍历顺序无关
+        std::sort(touched.begin(), touched.end());
+        synapses.clear();
+        for (int target : touched) {
+            Merged& m = byTarget[target];
+            double strength = mode == SynapseMergeMode::AVERAGE ? m.strength / m.count : m.strength;
+            synapses.emplace_back(master.indexOf(target), strength, m.lastUsed);
+            m.count = 0;
+        }
+        touched.clear();
+
+        // 合并后的强度从 master 的当前步开始衰减
+        master.neuronById(id).replaceSynapses(synapses, master.currentStep, master.params.decayRate);
+    }
+    master.refreshActiveSet();
+}
+
+// 用 master 的突触替换副本的突触并对齐步数，副本自己的神经元位置和状态保持不变
+static void adopt_synapses(NeuralNetworkSimulation& replica, const NeuralNetworkSimulation& master) {
+    replica.currentStep = master.currentStep;
+    std::vector<Synapse> synapses;
+    for (size_t id = 0; id < master.neurons.size(); ++id) {
+        synapses.clear();
+        for (const auto& synapse : master.neuronById(id).getSynapses()) {
+            if (!synapse.isActive) continue;
+            synapses.push_back(synapse);
+            synapses.back().targetNeuron = replica.indexOf(master.idOf(synapse.targetNeuron));
+        }
+        replica.neuronById(id).replaceSynapses(synapses, master.currentStep, master.params.decayRate);
+    }
+    replica.refreshActiveSet();
+}
+
+void train_data_parallel(NeuralNetworkSimulation& master, const std::vector<DigitImage>& images,
+                         int replicas, int mergeEvery, SynapseMergeMode mode, bool showProgress,
+                         const std::function<void(const NeuralNetworkSimulation&)>& afterStep) {
+    replicas = std::max(1, replicas);
+    mergeEvery = std::max(1, mergeEvery);
+
+    std::vector<std::vector<const DigitImage*>> shards(replicas);
+    for (size_t i = 0; i < images.size(); ++i) {
+        shards[i % replicas].push_back(&images[i]);
+    }
+
+    // 副本由 master 复制而来，随机序列相同，按副本编号重设种子使各副本的随机激活互不相同
+    std::vector<NeuralNetworkSimulation> workers(replicas, master);
+    for (int r = 1; r < replicas; ++r) {
+        workers[r].trace = nullptr;
+        workers[r].reseed(master.params.seed ? master.params.seed + r : 0);
+    }
+
+    // 每个副本一个常驻线程，整个训练过程中只创建一次：线程局部状态（如追踪记录器为每个线程
+    // 分配的缓冲区）在各轮之间复用。主线程每轮递增 round 唤醒各线程，等全部完成后再合并
+    const size_t longest = shards[0].size();
+    const size_t rounds = (longest + mergeEvery - 1) / mergeEvery;
+    std::mutex mutex;
+    std::condition_variable roundStart, roundDone;
+    size_t round = 0;        // 已发布的轮数，线程处理第 round-1 轮
+    int remaining = 0;       // 本轮尚未完成的副本数
+    bool quit = false;
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < replicas; ++r) {
+        threads.emplace_back([&, r] {
+            size_t done = 0;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    roundStart.wait(lock, [&] { return quit || round > done; });
+                    if (quit) return;
+                }
+                const size_t begin = done * mergeEvery;
+                const size_t end = std::min(shards[r].size(), begin + mergeEvery);
+                for (size_t i = begin; i < end; ++i) {
+                    train_on_image(workers[r], shards[r][i]->img, shards[r][i]->digit, false,
+                                   r == 0 ? afterStep : nullptr);
+                }
+                done++;
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--remaining == 0) roundDone.notify_one();
+            }
+        });
+    }
+
+    for (size_t current = 0; current < rounds; ++current) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            remaining = replicas;
+            round = current + 1;
+            roundStart.notify_all();
+            roundDone.wait(lock, [&] { return remaining == 0; });
+        }
+
+        merge_synapses(master, workers, mode);
+        if (current + 1 < rounds) {
+            for (auto& worker : workers) {
+                adopt_synapses(worker, master);
+            }
+        }
+        if (showProgress) {
+            std::cout << "\r并行训练: " << (current + 1) << "/" << rounds << " 轮，突触 "
+                      << master.getTotalSynapses() << "   " << std::flush;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    roundStart.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (showProgress) {
+        std::cout << std::endl;
+    }
+}
+
+bool parse_simulation_param(SimulationParams& params, const std::string& assignment) {
+    size_t eq = assignment.find('=');
+    if (eq == std::string::npos) return false;
+    std::string name = assignment.substr(0, eq);
+    double value;
+    try {
+        value = std::stod(assignment.substr(eq + 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    if (name == "threshold") params.connectionThreshold = value;
+    else if (name == "chance") params.activationChance = value;
+    else if (name == "lr") params.learningRate = value;
+    else if (name == "decay") params.decayRate = value;
+    else if (name == "steps") params.trainSteps = static_cast<int>(value);
+    else if (name == "seed") params.seed = static_cast<uint64_t>(value);
+    else return false;
+    return true;
+}
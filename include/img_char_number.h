@@ -0,0 +1,99 @@
+#ifndef IMG_CHAR_NUMBER_H
+#define IMG_CHAR_NUMBER_H
+
+#include "neuron_sim.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+// 数字识别任务（img_char_number）的公共参数和工具函数，供训练、识别、参数扫描共用
+
+const int DIGIT_SIM_WIDTH = 1000;
+const int DIGIT_SIM_HEIGHT = 800;
+const int DIGIT_INPUT_WIDTH = 28;    // MNIST格式大小
+const int DIGIT_INPUT_HEIGHT = 28;
+const int DIGIT_COUNT = 10;
+const int DIGIT_NUM_NEURONS = DIGIT_INPUT_WIDTH * DIGIT_INPUT_HEIGHT + DIGIT_COUNT;  // 输入层 + 10个输出神经元
+const double DIGIT_THRESHOLD = 250;
+const int DIGIT_RECOGNIZE_STEPS = 100;
+
+const char* const DIGIT_TRAIN_DIR = "./train/img/char/number";
+const char* const DIGIT_MODEL_PATH = "./train/result/img_char_number.bin";
+
+// 一张训练/测试图片
+struct DigitSample {
+    std::string path;
+    int digit;
+};
+
+// 已解码的图片及其标签
+struct DigitImage {
+    std::vector<std::vector<double>> img;
+    int digit;
+};
+
+// 合并副本突触时强度的组合方式
+enum class SynapseMergeMode {
+    AVERAGE,   // 在拥有该连接的副本之间取平均
+    MAX        // 取最大值
+};
+
+// 加载PNG图片并转换为灰度值（0-1），失败时返回空
+std::vector<std::vector<double>> load_png_image(const std::string& path, int target_width, int target_height);
+
+// 模型训练时使用的数据，保存在模型文件末尾，供评估时判断留出集是否参与过训练
+enum class TrainingData : int32_t {
+    UNKNOWN = 0,      // 未记录（旧模型或临时模型）
+    ALL_IMAGES = 1,   // 训练目录中的全部图片，包括留出集
+    TRAIN_SPLIT = 2,  // 只用 split_digit_samples 的训练集
+    SYNTHETIC = 3     // 只用合成样本，未读取训练目录
+};
+
+// 保存/加载训练结果（按神经元外部ID顺序存储的突触表，之后是记录 TrainingData 的文件尾）
+bool save_training_result(const NeuralNetworkSimulation& sim, const std::string& path,
+                          TrainingData data = TrainingData::UNKNOWN);
+bool load_training_result(NeuralNetworkSimulation& sim, const std::string& path);
+// 读取模型文件尾记录的训练数据，没有记录时返回 UNKNOWN
+TrainingData read_training_data(const std::string& path);
+
+// 用一张图片训练：激活输入层和对应数字的输出神经元，然后运行 params.trainSteps 步，
+// afterStep 非空时在每步之后调用（例如录制帧）
+void train_on_image(NeuralNetworkSimulation& sim, const std::vector<std::vector<double>>& img, int digit,
+                    bool showProgress = false,
+                    const std::function<void(const NeuralNetworkSimulation&)>& afterStep = nullptr);
+
+// 识别图片中的数字（会改变sim的状态）
+int recognize_digit(NeuralNetworkSimulation& sim, const std::vector<std::vector<double>>& img);
+
+// 列出 root/0 .. root/9 下的所有PNG，每个数字内按文件名排序
+std::vector<DigitSample> list_digit_samples(const std::string& root);
+
+// 固定的留出划分：每个数字内每5张中的第1张划入测试集，其余为训练集
+void split_digit_samples(const std::vector<DigitSample>& all,
+                         std::vector<DigitSample>& train, std::vector<DigitSample>& holdout);
+
+// 解码样本图片，perDigit > 0 时每个数字最多取 perDigit 张，无法解码的图片被跳过
+std::vector<DigitImage> load_digit_images(const std::vector<DigitSample>& samples, size_t perDigit = 0);
+
+// 打包的数据集：文件头 "NDPK"、图片数、宽、高（均为uint32），之后每张图片为
+// 1字节标签 + 宽*高字节灰度（0-255）。省去逐个文件的PNG解码，用于批量评估
+bool save_digit_pack(const std::vector<DigitImage>& images, const std::string& path);
+// 读取打包的数据集，失败时返回false且 images 为空
+bool load_digit_pack(std::vector<DigitImage>& images, const std::string& path);
+
+// 把各副本的突触合并到 master：按外部ID取连接的并集，强度按 mode 组合，最后使用时间取最大值。
+// master 原有的突触被替换，神经元状态不变
+void merge_synapses(NeuralNetworkSimulation& master, const std::vector<NeuralNetworkSimulation>& replicas,
+                    SynapseMergeMode mode);
+
+// 数据并行训练：图片轮流分到 replicas 个互不相交的分片，每个副本在独立线程中训练自己的分片；
+// 每个副本训练 mergeEvery 张图片后把所有副本合并到 master，再把合并后的突触分发回各副本。
+// afterStep 只对第0个副本调用，master.trace 也只传给第0个副本
+void train_data_parallel(NeuralNetworkSimulation& master, const std::vector<DigitImage>& images,
+                         int replicas, int mergeEvery, SynapseMergeMode mode, bool showProgress = false,
+                         const std::function<void(const NeuralNetworkSimulation&)>& afterStep = nullptr);
+
+// 按 "名称=值" 设置模拟参数，名称为 threshold/chance/lr/decay/steps/seed，无法识别时返回false
+bool parse_simulation_param(SimulationParams& params, const std::string& assignment);
+
+#endif // IMG_CHAR_NUMBER_H
@@ -0,0 +1,140 @@
+#include "inference.h"
+#include "img_char_number.h"
+#include <algorithm>
+#include <cmath>
+
+FixedPointArithmetic::Weight FixedPointArithmetic::weight(double strength) {
+    return static_cast<Weight>(std::lround(std::max(0.0, std::min(1.0, strength)) * WEIGHT_ONE));
+}
+
+template <typename Arithmetic>
+BasicInferenceEngine<Arithmetic>::BasicInferenceEngine(const NeuralNetworkSimulation& model, double activationChance,
+                                                       uint64_t seed)
+    : rngState(seed ? seed : 1) {
+    const size_t n = model.neurons.size();
+    outputStart = static_cast<int>(n) - std::min<int>(DIGIT_COUNT, static_cast<int>(n));
+
+    // 按外部ID建立CSR
+    offsets.assign(n + 1, 0);
+    for (size_t id = 0; id < n; ++id) {
+        for (const auto& synapse : model.neuronById(id).getSynapses()) {
+            if (!synapse.isActive) continue;
+            targets.push_back(static_cast<uint32_t>(model.idOf(synapse.targetNeuron)));
+            weights.push_back(Arithmetic::weight(synapse.strength));
+        }
+        offsets[id + 1] = static_cast<uint32_t>(targets.size());
+    }
+
+    potential.assign(n, Potential(0));
+    activation.assign(n, Activation(0));
+    lastFired.assign(n, -REFRACTORY);
+    input.assign(n, Potential(0));
+    spikingFlag.assign(n, 0);
+    spiking.reserve(n);
+
+    double chance = std::max(0.0, std::min(1.0, activationChance));
+    chanceThreshold = static_cast<uint32_t>(std::min(4294967295.0, chance * 4294967296.0));
+}
+
+template <typename Arithmetic>
+uint64_t BasicInferenceEngine<Arithmetic>::nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+template <typename Arithmetic>
+void BasicInferenceEngine<Arithmetic>::reset() {
+    std::fill(potential.begin(), potential.end(), Potential(0));
+    std::fill(activation.begin(), activation.end(), Activation(0));
+    std::fill(lastFired.begin(), lastFired.end(), -REFRACTORY);
+    std::fill(input.begin(), input.end(), Potential(0));
+    std::fill(spikingFlag.begin(), spikingFlag.end(), 0);
+    spiking.clear();
+}
+
+template <typename Arithmetic>
+void BasicInferenceEngine<Arithmetic>::step(int t) {
+    const size_t n = potential.size();
+
+    // 传递：signal = strength * activation，膜电位增加 signal * 10 mV
+    for (uint32_t source : spiking) {
+        const auto scale = Arithmetic::scale(activation[source]);
+        for (uint32_t k = offsets[source]; k < offsets[source + 1]; ++k) {
+            input[targets[k]] += Arithmetic::signal(weights[k], scale);
+        }
+    }
+
+    // 阈值发放 + 衰减 + 泄漏，与 receiveSignal/fire/update 等价：
+    // 电位只增不减，逐个累加过程中越过阈值 等价于 总输入越过阈值；发放后其余输入被不应期忽略
+    // 电位在越过阈值前不超过 15 mV，单步输入之和也远小于定点表示的范围，不需要饱和
+    Potential* p = potential.data();
+    Activation* act = activation.data();
+    int32_t* last = lastFired.data();
+    Potential* in = input.data();
+    uint8_t* flag = spikingFlag.data();
+    for (size_t i = 0; i < n; ++i) {
+        const bool refractory = t - last[i] < REFRACTORY;
+        Potential v = p[i] + (refractory ? Potential(0) : in[i]);
+        const bool fired = !refractory && v >= Arithmetic::THRESHOLD;
+        Activation a = fired ? Arithmetic::ACTIVATION_ONE : act[i];
+        const int32_t l = fired ? t : last[i];
+        v = fired ? Potential(0) : v;
+        a = Arithmetic::decay(a);
+        const bool leak = !fired && !flag[i] && t - l >= REFRACTORY && v > Potential(0);
+        v -= leak ? Arithmetic::LEAK : Potential(0);
+
+        p[i] = v;
+        act[i] = a;
+        last[i] = l;
+        in[i] = Potential(0);
+        flag[i] = 0;
+    }
+
+    // 随机激活（在下一步传出）
+    spiking.clear();
+    if (chanceThreshold == 0) return;
+    for (size_t i = 0; i < n; ++i) {
+        if ((nextRandom() >> 32) < chanceThreshold) {
+            p[i] = Potential(0);
+            act[i] = Arithmetic::ACTIVATION_ONE;
+            last[i] = t;
+            flag[i] = 1;
+            spiking.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+template <typename Arithmetic>
+int BasicInferenceEngine<Arithmetic>::recognize(const std::vector<std::vector<double>>& img) {
+    reset();
+    const int n = static_cast<int>(potential.size());
+
+    // 激活输入层（外部ID即像素下标），在第1步传出
+    for (size_t y = 0; y < img.size(); ++y) {
+        for (size_t x = 0; x < img[y].size(); ++x) {
+            int id = static_cast<int>(y * img[y].size() + x);
+            if (img[y][x] > 0.5 && id < n) {
+                activation[id] = Arithmetic::ACTIVATION_ONE;
+                lastFired[id] = 0;
+                spikingFlag[id] = 1;
+                spiking.push_back(static_cast<uint32_t>(id));
+            }
+        }
+    }
+
+    for (int t = 1; t <= DIGIT_RECOGNIZE_STEPS; ++t) {
+        step(t);
+    }
+
+    // 激活水平最高的输出神经元（相同时取编号小的）
+    int best = 0;
+    for (int d = 1; d < n - outputStart; ++d) {
+        if (activation[outputStart + d] > activation[outputStart + best]) best = d;
+    }
+    return best;
+}
+
+template class BasicInferenceEngine<FixedPointArithmetic>;
+template class BasicInferenceEngine<DoubleArithmetic>;
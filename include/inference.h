@@ -0,0 +1,113 @@
+#ifndef INFERENCE_H
+#define INFERENCE_H
+
+#include <cstdint>
+#include <vector>
+#include "neuron_sim.h"
+
+// 只做前向推理的识别引擎。
+//
+// 从训练好的模型中取出活跃突触，冻结为按外部ID编号的CSR表，不再移动神经元、建立新连接或
+// 更新突触。数值表示是模板参数：InferenceEngine 为定点实现，FrozenDoubleEngine 用 double
+// 执行完全相同的步骤，两者的差别只来自量化（与原实现的差别则还包括被冻结的拓扑和可塑性）。
+// 动力学与 receiveSignal/fire/update 一致：
+// - 脉冲传递按源神经元散射累加到输入缓冲区，再由一次逐神经元的稠密循环完成
+//   不应期判断、阈值发放、激活衰减和电位泄漏（该循环无分支依赖，可被编译器向量化）
+// - 与原实现一样，被突触输入触发的发放只影响激活水平，不在下一步继续传递
+// - activationChance > 0 时按该概率随机激活神经元（与 step() 中的随机激活相同），0 表示完全确定；
+//   相同种子下两种实现抽到的随机激活相同
+//
+// 引擎内部带有每张图片的运行状态，多线程时每个线程使用自己的副本。
+
+// 定点表示。膜电位在识别过程中始终处于 [-1, 15) mV（相对静息电位，越过阈值即复位），
+// 用 1/4096 mV 的int32；权重为16位；激活水平为Q16，只用于比较输出神经元的先后
+// （同一步发放的相等，先发放的更小，100步内不会衰减到0），以及源神经元的信号缩放
+struct FixedPointArithmetic {
+    using Potential = int32_t;
+    using Activation = uint16_t;
+    using Weight = uint16_t;
+    using Scale = uint32_t;
+
+    static constexpr Potential MILLIVOLT = 4096;
+    static constexpr Potential THRESHOLD = 15 * MILLIVOLT;   // 阈值电位 -55 mV 相对静息 -70 mV
+    static constexpr Potential LEAK = 1 * MILLIVOLT;
+    static constexpr Activation ACTIVATION_ONE = 65535;
+    static constexpr uint32_t WEIGHT_ONE = 65535;
+
+    static Weight weight(double strength);
+    // 每个源神经元先算出Q16比例（每单位权重对应的电位），突触上只做一次乘法和移位
+    static Scale scale(Activation activation) {
+        const uint64_t denominator = static_cast<uint64_t>(WEIGHT_ONE) * ACTIVATION_ONE;
+        return static_cast<Scale>((static_cast<uint64_t>(activation) * 10 * MILLIVOLT * 65536 + denominator / 2) /
+                                  denominator);
+    }
+    static Potential signal(Weight weight, Scale scale) {
+        return static_cast<Potential>((static_cast<uint32_t>(weight) * scale + 32768) >> 16);
+    }
+    static Activation decay(Activation activation) {
+        return static_cast<Activation>((static_cast<uint32_t>(activation) * 62259) >> 16);   // 0.95 * 65536
+    }
+};
+
+// 与 Neuron 相同的 double 运算：膜电位单位为 mV（相对静息电位）
+struct DoubleArithmetic {
+    using Potential = double;
+    using Activation = double;
+    using Weight = double;
+    using Scale = double;
+
+    static constexpr Potential THRESHOLD = 15.0;
+    static constexpr Potential LEAK = 1.0;
+    static constexpr Activation ACTIVATION_ONE = 1.0;
+
+    static Weight weight(double strength) { return strength; }
+    static Scale scale(Activation activation) { return activation; }
+    static Potential signal(Weight weight, Scale scale) { return weight * scale * 10.0; }
+    static Activation decay(Activation activation) { return activation * 0.95; }
+};
+
+template <typename Arithmetic>
+class BasicInferenceEngine {
+public:
+    using Potential = typename Arithmetic::Potential;
+    using Activation = typename Arithmetic::Activation;
+    using Weight = typename Arithmetic::Weight;
+
+    explicit BasicInferenceEngine(const NeuralNetworkSimulation& model, double activationChance = 0.0,
+                                  uint64_t seed = 1);
+
+    // 识别一张28x28图片，返回数字
+    int recognize(const std::vector<std::vector<double>>& img);
+
+    size_t getNeuronCount() const { return potential.size(); }
+    size_t getSynapseCount() const { return targets.size(); }
+
+private:
+    static constexpr int REFRACTORY = 5;
+
+    void reset();
+    void step(int t);
+    uint64_t nextRandom();
+
+    // 冻结的拓扑：源神经元 i 的突触为 targets/weights[offsets[i], offsets[i+1])
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<Weight> weights;
+    int outputStart;
+
+    // 每张图片的运行状态（SoA）
+    std::vector<Potential> potential;
+    std::vector<Activation> activation;
+    std::vector<int32_t> lastFired;
+    std::vector<Potential> input;      // 本步收到的突触输入
+    std::vector<uint8_t> spikingFlag;  // 上一步末被外部刺激/随机激活，本步传出脉冲（update中不泄漏）
+    std::vector<uint32_t> spiking;     // spikingFlag 为1的神经元列表
+
+    uint32_t chanceThreshold;          // 随机激活概率（32位定点）
+    uint64_t rngState;
+};
+
+using InferenceEngine = BasicInferenceEngine<FixedPointArithmetic>;
+using FrozenDoubleEngine = BasicInferenceEngine<DoubleArithmetic>;
+
+#endif // INFERENCE_H
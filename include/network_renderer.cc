@@ -0,0 +1,195 @@
+#include "network_renderer.h"
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+NetworkRenderer::NetworkRenderer()
+    : densitySurface(nullptr), densityWidth(0), densityHeight(0),
+      densityThreshold(50000.0), lastFrameMs(0.0), usedDensity(false) {
+    for (auto& g : glyphs) g = nullptr;
+}
+
+NetworkRenderer::~NetworkRenderer() {
+    for (auto& g : glyphs) {
+        if (g) cairo_surface_destroy(g);
+    }
+    if (densitySurface) cairo_surface_destroy(densitySurface);
+}
+
+void NetworkRenderer::render(cairo_t* cr, const RenderSnapshot& snapshot, int width, int height,
+                             const HoveredSynapseInfo* hovered) {
+    auto start = std::chrono::steady_clock::now();
+
+    // 绘制背景
+    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
+    cairo_paint(cr);
+
+    // 绘制突触连接：过密时使用密度图
+    double megapixels = std::max(1.0, static_cast<double>(width) * height) / 1e6;
+    usedDensity = densityThreshold > 0 && snapshot.synapses.size() > densityThreshold * megapixels;
+    if (usedDensity) {
+        drawSynapsesDensity(cr, snapshot, width, height);
+    } else {
+        drawSynapsesBatched(cr, snapshot);
+    }
+
+    if (hovered && hovered->isHovered) {
+        drawHoveredSynapse(cr, snapshot, *hovered);
+    }
+
+    drawNeurons(cr, snapshot);
+
+    auto end = std::chrono::steady_clock::now();
+    lastFrameMs = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void NetworkRenderer::drawSynapsesBatched(cairo_t* cr, const RenderSnapshot& snapshot) {
+    for (auto& bucket : buckets) bucket.clear();
+
+    for (const auto& synapse : snapshot.synapses) {
+        const auto& pos = snapshot.positions[synapse.source];
+        const auto& targetPos = snapshot.positions[synapse.target];
+        int b = std::max(0, std::min(STRENGTH_BUCKETS - 1, static_cast<int>(synapse.strength * STRENGTH_BUCKETS)));
+        auto& bucket = buckets[b];
+        bucket.push_back(pos.x);
+        bucket.push_back(pos.y);
+        bucket.push_back(targetPos.x);
+        bucket.push_back(targetPos.y);
+    }
+
+    // 突触强度决定线条透明度和宽度，同一桶内的突触合并为一次描边
+    for (int b = 0; b < STRENGTH_BUCKETS; ++b) {
+        const auto& bucket = buckets[b];
+        if (bucket.empty()) continue;
+        double strength = (b + 0.5) / STRENGTH_BUCKETS;
+        cairo_set_source_rgba(cr, 0.5, 0.8, 1.0, strength);
+        cairo_set_line_width(cr, 0.5 + (strength * 1.5));
+        for (size_t k = 0; k < bucket.size(); k += 4) {
+            cairo_move_to(cr, bucket[k], bucket[k + 1]);
+            cairo_line_to(cr, bucket[k + 2], bucket[k + 3]);
+        }
+        cairo_stroke(cr);
+    }
+}
+
+void NetworkRenderer::drawSynapsesDensity(cairo_t* cr, const RenderSnapshot& snapshot, int width, int height) {
+    const int dw = (width + DENSITY_SCALE - 1) / DENSITY_SCALE;
+    const int dh = (height + DENSITY_SCALE - 1) / DENSITY_SCALE;
+    if (dw <= 0 || dh <= 0) return;
+    density.assign(static_cast<size_t>(dw) * dh, 0.0f);
+
+    // 按强度加权，把每条突触以DDA方式光栅化到低分辨率缓冲区
+    const double inv = 1.0 / DENSITY_SCALE;
+    for (const auto& synapse : snapshot.synapses) {
+        const auto& pos = snapshot.positions[synapse.source];
+        const auto& targetPos = snapshot.positions[synapse.target];
+        double x = pos.x * inv, y = pos.y * inv;
+        double dx = targetPos.x * inv - x, dy = targetPos.y * inv - y;
+        int steps = static_cast<int>(std::max(std::fabs(dx), std::fabs(dy))) + 1;
+        double sx = dx / steps, sy = dy / steps;
+        for (int k = 0; k <= steps; ++k, x += sx, y += sy) {
+            int px = static_cast<int>(x), py = static_cast<int>(y);
+            if (px >= 0 && px < dw && py >= 0 && py < dh) {
+                density[static_cast<size_t>(py) * dw + px] += synapse.strength;
+            }
+        }
+    }
+
+    if (!densitySurface || densityWidth != dw || densityHeight != dh) {
+        if (densitySurface) cairo_surface_destroy(densitySurface);
+        densitySurface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, dw, dh);
+        densityWidth = dw;
+        densityHeight = dh;
+    }
+
+    // 累积值映射为与逐条绘制相同的蓝色，透明度随密度饱和（预乘alpha）
+    cairo_surface_flush(densitySurface);
+    unsigned char* data = cairo_image_surface_get_data(densitySurface);
+    const int stride = cairo_image_surface_get_stride(densitySurface);
+    for (int y = 0; y < dh; ++y) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(data + static_cast<size_t>(y) * stride);
+        const float* src = &density[static_cast<size_t>(y) * dw];
+        for (int x = 0; x < dw; ++x) {
+            float a = 1.0f - std::exp(-0.6f * src[x]);
+            uint32_t A = static_cast<uint32_t>(a * 255.0f);
+            uint32_t R = static_cast<uint32_t>(0.5f * a * 255.0f);
+            uint32_t G = static_cast<uint32_t>(0.8f * a * 255.0f);
+            row[x] = (A << 24) | (R << 16) | (G << 8) | A;
+        }
+    }
+    cairo_surface_mark_dirty(densitySurface);
+
+    cairo_save(cr);
+    cairo_scale(cr, DENSITY_SCALE, DENSITY_SCALE);
+    cairo_set_source_surface(cr, densitySurface, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BILINEAR);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+void NetworkRenderer::drawHoveredSynapse(cairo_t* cr, const RenderSnapshot& snapshot,
+                                         const HoveredSynapseInfo& hovered) {
+    const int count = static_cast<int>(snapshot.indexOfId.size());
+    if (hovered.sourceId < 0 || hovered.sourceId >= count || hovered.targetId < 0 || hovered.targetId >= count) {
+        return;
+    }
+    const auto& pos = snapshot.positions[snapshot.indexOfId[hovered.sourceId]];
+    const auto& targetPos = snapshot.positions[snapshot.indexOfId[hovered.targetId]];
+
+    // 当前悬停的突触黄色高亮，线宽增加
+    cairo_set_source_rgba(cr, 1.0, 1.0, 0.0, 1.0);
+    cairo_set_line_width(cr, 0.5 + (hovered.strength * 1.5) + 1.0);
+    cairo_move_to(cr, pos.x, pos.y);
+    cairo_line_to(cr, targetPos.x, targetPos.y);
+    cairo_stroke(cr);
+}
+
+// 预渲染某一激活级别的神经元图元
+cairo_surface_t* NetworkRenderer::glyph(int level) {
+    if (glyphs[level]) return glyphs[level];
+
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, GLYPH_SIZE, GLYPH_SIZE);
+    cairo_t* g = cairo_create(surface);
+    const double center = GLYPH_SIZE / 2.0;
+
+    double activation;
+    if (level == GLYPH_LEVELS) {
+        // 正在发放的神经元显示为红色
+        activation = 1.0;
+        cairo_set_source_rgb(g, 1.0, 0.2, 0.2);
+    } else {
+        // 激活水平高的神经元显示为更亮的蓝色
+        activation = static_cast<double>(level) / (GLYPH_LEVELS - 1);
+        cairo_set_source_rgb(g, 0.3, 0.5 + activation * 0.5, 1.0);
+    }
+
+    // 绘制神经元主体和边框
+    double radius = 5.0 + (activation * 3.0);
+    cairo_arc(g, center, center, radius, 0, 2 * M_PI);
+    cairo_fill(g);
+    cairo_set_source_rgb(g, 0.9, 0.9, 0.9);
+    cairo_set_line_width(g, 1.0);
+    cairo_arc(g, center, center, radius, 0, 2 * M_PI);
+    cairo_stroke(g);
+
+    cairo_destroy(g);
+    glyphs[level] = surface;
+    return surface;
+}
+
+void NetworkRenderer::drawNeurons(cairo_t* cr, const RenderSnapshot& snapshot) {
+    const double half = GLYPH_SIZE / 2.0;
+    for (size_t i = 0; i < snapshot.positions.size(); ++i) {
+        int level = snapshot.firing[i]
+            ? GLYPH_LEVELS
+            : std::min(GLYPH_LEVELS - 1, static_cast<int>(std::lround(snapshot.activations[i] * (GLYPH_LEVELS - 1))));
+        const auto& pos = snapshot.positions[i];
+        // 贴图位置对齐到整数像素，避免逐个神经元的重采样
+        double x = std::round(pos.x - half);
+        double y = std::round(pos.y - half);
+        cairo_set_source_surface(cr, glyph(level), x, y);
+        cairo_rectangle(cr, x, y, GLYPH_SIZE, GLYPH_SIZE);
+        cairo_fill(cr);
+    }
+}
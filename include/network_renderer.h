@@ -0,0 +1,62 @@
+#ifndef NETWORK_RENDERER_H
+#define NETWORK_RENDERER_H
+
+#include <cairo.h>
+#include <vector>
+#include "render_snapshot.h"
+
+// 存储当前悬停的突触信息
+struct HoveredSynapseInfo {
+    bool isHovered;          // 是否悬停在突触上
+    int sourceId;            // 源神经元外部ID（不用快照下标：重排后新快照的下标指向别的神经元）
+    int targetId;            // 目标神经元外部ID
+    double strength;         // 突触强度
+    double lastUsedStep;     // 最后使用的模拟步数
+};
+
+// 用cairo绘制神经网络快照，与窗口无关（GTK窗口和离屏渲染共用）
+//
+// - 突触按强度量化分桶，每个桶只设置一次颜色/线宽并合并为一条路径描边
+// - 神经元按激活水平量化，使用预渲染的图元表面贴图，不再逐个画圆
+// - 屏幕上突触过密时切换为密度图模式：把所有突触光栅化到一张低分辨率图像后一次绘制
+class NetworkRenderer {
+public:
+    NetworkRenderer();
+    ~NetworkRenderer();
+    NetworkRenderer(const NetworkRenderer&) = delete;
+    NetworkRenderer& operator=(const NetworkRenderer&) = delete;
+
+    // 绘制一帧，hovered 可以为空
+    void render(cairo_t* cr, const RenderSnapshot& snapshot, int width, int height,
+                const HoveredSynapseInfo* hovered);
+
+    // 每百万像素超过该突触数时使用密度图模式，0表示始终逐条绘制
+    void setDensityThreshold(double synapsesPerMegapixel) { densityThreshold = synapsesPerMegapixel; }
+
+    double getLastFrameMs() const { return lastFrameMs; }
+    bool lastFrameUsedDensity() const { return usedDensity; }
+
+private:
+    static constexpr int STRENGTH_BUCKETS = 16;
+    static constexpr int GLYPH_LEVELS = 16;
+    static constexpr int DENSITY_SCALE = 2;      // 密度图每个像素覆盖 2x2 屏幕像素
+    static constexpr int GLYPH_SIZE = 24;        // 图元表面边长（最大半径8加描边）
+
+    void drawSynapsesBatched(cairo_t* cr, const RenderSnapshot& snapshot);
+    void drawSynapsesDensity(cairo_t* cr, const RenderSnapshot& snapshot, int width, int height);
+    void drawHoveredSynapse(cairo_t* cr, const RenderSnapshot& snapshot, const HoveredSynapseInfo& hovered);
+    void drawNeurons(cairo_t* cr, const RenderSnapshot& snapshot);
+    cairo_surface_t* glyph(int level);
+
+    std::vector<double> buckets[STRENGTH_BUCKETS];   // 每个桶的线段端点 x1,y1,x2,y2
+    cairo_surface_t* glyphs[GLYPH_LEVELS + 1];       // 最后一个为发放中的神经元
+    std::vector<float> density;                      // 密度累积缓冲区
+    cairo_surface_t* densitySurface;
+    int densityWidth, densityHeight;
+
+    double densityThreshold;
+    double lastFrameMs;
+    bool usedDensity;
+};
+
+#endif // NETWORK_RENDERER_H
@@ -1,7 +1,9 @@
 #include "neuron_sim.h"
+#include "event_trace.h"
 #include <random>
 #include <chrono>
 #include <algorithm>
+#include <cstdint>
 
 // 初始化Synapse类的静态成员变量
 const double Synapse::STRENGTH_MIN = 0.1;
@@ -35,15 +37,16 @@ double distance(const Vector2D& a, const Vector2D& b) {
 }
 
 // Synapse 实现
-Synapse::Synapse(int target, double str, double initTime) 
-    : targetNeuron(target), strength(str), lastUsed(initTime), isActive(true) {}
+Synapse::Synapse(int target, double str, double initTime, double decayFrom) 
+    : targetNeuron(target), isActive(true), strength(str), lastUsed(initTime),
+      decayBase(str), decayFrom(decayFrom) {}
 
-void Synapse::strengthen() {
-    strength = std::min(STRENGTH_MAX, strength + LEARNING_RATE);
+void Synapse::strengthen(double learningRate) {
+    strength = std::min(STRENGTH_MAX, strength + learningRate);
 }
 
-void Synapse::decay() {
-    strength = std::max(STRENGTH_MIN, strength - DECAY_RATE);
+void Synapse::decay(double decayRate) {
+    strength = std::max(STRENGTH_MIN, strength - decayRate);
 }
 
 void Synapse::checkInactivity(double currentTime) {
@@ -60,14 +63,15 @@ void Synapse::use(double currentTime) {
 }
 
 // Neuron 实现
-Neuron::Neuron(double x, double y) : position(x, y), 
+Neuron::Neuron(double x, double y, std::mt19937& gen) : position(x, y), 
+                                 synapsesSyncedAt(0.0),
+                                 synapseClock(0.0),
+                                 synapseDecayRate(Synapse::DECAY_RATE),
                                  activationLevel(0.0),
                                  potential(RESTING_POTENTIAL),
                                  isFiring(false),
                                  lastFired(-REFRACTORY_PERIOD),
                                  activationDecay(0.95) {
-    auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::mt19937 gen(seed);
     std::uniform_real_distribution<double> dirDist(-1.0, 1.0);
     std::uniform_real_distribution<double> speedDist(0.1, 0.5);
     
@@ -76,9 +80,28 @@ Neuron::Neuron(double x, double y) : position(x, y),
     speed = speedDist(gen);
 }
 
+Neuron::Neuron(const NeuronState& state, std::vector<Synapse> synapses)
+    : position(state.position),
+      direction(state.direction),
+      speed(state.speed),
+      synapses(std::move(synapses)),
+      synapsesSyncedAt(state.synapseClock),
+      synapseClock(state.synapseClock),
+      synapseDecayRate(state.synapseDecayRate),
+      activationLevel(state.activationLevel),
+      potential(state.potential),
+      isFiring(state.isFiring),
+      lastFired(state.lastFired),
+      activationDecay(state.activationDecay) {}
+
+NeuronState Neuron::getState() const {
+    return {position, direction, speed, activationLevel, potential, isFiring, lastFired, activationDecay,
+            synapseClock, synapseDecayRate};
+}
+
 const Vector2D& Neuron::getPosition() const { return position; }
 
-void Neuron::move(double width, double height) {
+void Neuron::move(double width, double height, std::mt19937& gen) {
     position = position + direction * speed;
     
     // 边界检查，碰到边界反弹
@@ -93,8 +116,6 @@ void Neuron::move(double width, double height) {
     }
     
     // 微小的随机方向变化
-    auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::mt19937 gen(seed);
     std::normal_distribution<double> dirChange(0.0, 0.1);
     
     direction.x += dirChange(gen);
@@ -102,13 +123,29 @@ void Neuron::move(double width, double height) {
     direction.normalize();
 }
 
-void Neuron::connectTo(int targetNeuron, double strength, double currentTime) {
-    for (const auto& synapse : synapses) {
-        if (synapse.targetNeuron == targetNeuron && synapse.isActive) {
-            return;
+bool Neuron::connectTo(int targetNeuron, double strength, double currentTime) {
+    size_t freeSlot = synapses.size();
+    for (size_t i = 0; i < synapses.size(); ++i) {
+        const auto& synapse = synapses[i];
+        if (!synapse.activeAt(synapseClock)) {
+            if (freeSlot == synapses.size()) freeSlot = i;
+        } else if (synapse.targetNeuron == targetNeuron) {
+            return false;
         }
     }
-    synapses.emplace_back(targetNeuron, strength, currentTime);
+    
+    // 优先复用已失活的槽位
+    if (freeSlot < synapses.size()) {
+        synapses[freeSlot] = Synapse(targetNeuron, strength, currentTime, synapseClock);
+        return true;
+    }
+    
+    // 没有空槽时按大小级别扩容，避免逐个增长造成的反复重分配
+    if (synapses.size() == synapses.capacity()) {
+        synapses.reserve(std::max(SYNAPSE_BLOCK_MIN, synapses.capacity() * 2));
+    }
+    synapses.emplace_back(targetNeuron, strength, currentTime, synapseClock);
+    return true;
 }
 
 bool Neuron::isCloseEnough(const Neuron& other, double threshold) const {
@@ -116,6 +153,7 @@ bool Neuron::isCloseEnough(const Neuron& other, double threshold) const {
 }
 
 std::vector<Synapse> Neuron::getActiveSynapses() const {
+    syncSynapses();
     std::vector<Synapse> result;
     for (const auto& synapse : synapses) {
         if (synapse.isActive) {
@@ -125,6 +163,59 @@ std::vector<Synapse> Neuron::getActiveSynapses() const {
     return result;
 }
 
+const std::vector<Synapse>& Neuron::getSynapses() const {
+    syncSynapses();
+    return synapses;
+}
+
+size_t Neuron::getActiveSynapseCount() const {
+    syncSynapses();
+    size_t count = 0;
+    for (const auto& synapse : synapses) {
+        if (synapse.isActive) count++;
+    }
+    return count;
+}
+
+void Neuron::advanceSynapseClock(double t, double decayRate) {
+    if (decayRate != synapseDecayRate) {
+        syncSynapses();
+        for (auto& synapse : synapses) {
+            if (synapse.isActive) {
+                synapse.decayBase = synapse.strength;
+                synapse.decayFrom = synapseClock;
+            }
+        }
+        synapseDecayRate = decayRate;
+    }
+    // 时钟只向前走（副本对齐步数等场合可能传入更早的步）
+    synapseClock = std::max(synapseClock, t);
+}
+
+void Neuron::syncSynapses() const {
+    if (synapsesSyncedAt == synapseClock) return;
+    for (auto& synapse : synapses) {
+        if (!synapse.isActive) continue;
+        double inactiveFrom = synapse.inactiveFrom();
+        // 失活的那一步仍先衰减，之后强度不再变化
+        synapse.strength = synapse.strengthAt(std::min(synapseClock, inactiveFrom), synapseDecayRate);
+        if (inactiveFrom <= synapseClock) synapse.isActive = false;
+    }
+    synapsesSyncedAt = synapseClock;
+}
+
+void Neuron::replaceSynapses(const std::vector<Synapse>& replacement, double t, double decayRate) {
+    synapses.assign(replacement.begin(), replacement.end());
+    synapseClock = t;
+    synapseDecayRate = decayRate;
+    for (auto& synapse : synapses) {
+        synapse.decayBase = synapse.strength;
+        synapse.decayFrom = t;
+        if (!synapse.activeAt(t)) synapse.isActive = false;
+    }
+    synapsesSyncedAt = t;
+}
+
 void Neuron::receiveSignal(double signalStrength, double currentTime) {
     if (currentTime - lastFired < REFRACTORY_PERIOD) {
         return;
@@ -144,7 +235,12 @@ void Neuron::fire(double currentTime) {
     potential = RESTING_POTENTIAL;
 }
 
-void Neuron::update(double currentTime) {
+void Neuron::update(double currentTime, double learningRate, double decayRate) {
+    updateDynamics(currentTime);
+    updateSynapses(currentTime, learningRate, decayRate);
+}
+
+void Neuron::updateDynamics(double currentTime) {
     activationLevel *= activationDecay;
     
     if (!isFiring && currentTime - lastFired >= REFRACTORY_PERIOD) {
@@ -154,90 +250,283 @@ void Neuron::update(double currentTime) {
     }
     
     isFiring = false;
-    updateSynapses(currentTime);
 }
 
-void Neuron::updateSynapses(double currentTime) {
+void Neuron::updateSynapses(double currentTime, double learningRate, double decayRate) {
+    advanceSynapseClock(currentTime, decayRate);
+    syncSynapses();
+    if (!strengthensAt(currentTime)) return;
     for (auto& synapse : synapses) {
         if (synapse.isActive) {
-            synapse.decay();
-            
-            if (currentTime - lastFired < 1.0) {
-                synapse.strengthen();
-            }
-            
-            synapse.checkInactivity(currentTime);
+            synapse.strength = std::min(Synapse::STRENGTH_MAX, synapse.strength + learningRate);
+            synapse.decayBase = synapse.strength;
+            synapse.decayFrom = synapseClock;
         }
     }
 }
 
+void Neuron::remapTargets(const std::vector<int>& oldToNew) {
+    for (auto& synapse : synapses) {
+        synapse.targetNeuron = oldToNew[synapse.targetNeuron];
+    }
+}
+
+bool Neuron::settle(double epsilon) {
+    if (activationLevel < epsilon) activationLevel = 0.0;
+    return activationLevel <= 0.0 && !isFiring && potential <= RESTING_POTENTIAL;
+}
+
 bool Neuron::firing() const { return isFiring; }
 double Neuron::getActivationLevel() const { return activationLevel; }
+double Neuron::getLastFired() const { return lastFired; }
 
 // NeuralNetworkSimulation 实现
 NeuralNetworkSimulation::NeuralNetworkSimulation(int numNeurons, double w, double h, double threshold)
-    : width(w), height(h), connectionThreshold(threshold), currentStep(0) {
-    auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::mt19937 gen(seed);
+    : NeuralNetworkSimulation(numNeurons, w, h, SimulationParams{threshold}) {}
+
+NeuralNetworkSimulation::NeuralNetworkSimulation(int numNeurons, double w, double h, const SimulationParams& params)
+    : width(w), height(h), params(params), currentStep(0), reorderInterval(500), trace(nullptr),
+      updateSeconds(0), activeSetStale(false) {
+    firingScratch.reserve(numNeurons);
+    activeList.reserve(numNeurons);
+    inActiveSet.assign(numNeurons, 0);
+    reseed(params.seed);
     std::uniform_real_distribution<double> xDist(0, width);
     std::uniform_real_distribution<double> yDist(0, height);
     
     for (int i = 0; i < numNeurons; ++i) {
-        neurons.emplace_back(xDist(gen), yDist(gen));
+        double x = xDist(rng);
+        double y = yDist(rng);
+        neurons.emplace_back(x, y, rng);
+        idToIndex.push_back(i);
+        indexToId.push_back(i);
+    }
+}
+
+void NeuralNetworkSimulation::reseed(uint64_t seed) {
+    if (seed == 0) {
+        seed = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    }
+    std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+    rng.seed(seq);
+}
+
+void NeuralNetworkSimulation::stimulate(int id) {
+    neuronById(id).fire(currentStep);
+    markActive(indexOf(id));
+}
+
+bool NeuralNetworkSimulation::connect(int id, int targetId, double strength, double currentTime) {
+    return neuronById(id).connectTo(indexOf(targetId), strength, currentTime);
+}
+
+void NeuralNetworkSimulation::refreshActiveSet() {
+    activeList.clear();
+    inActiveSet.assign(neurons.size(), 0);
+    for (size_t i = 0; i < neurons.size(); ++i) {
+        neurons[i].advanceSynapseClock(currentStep, params.decayRate);
+        if (!neurons[i].settle(ACTIVITY_EPSILON)) markActive(static_cast<int>(i));
+    }
+    activeSetStale = false;
+}
+
+// 将16位坐标按位交错得到Morton码（Z序曲线）
+static uint32_t mortonKey(uint32_t x, uint32_t y) {
+    auto spread = [](uint32_t v) {
+        v &= 0x0000FFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+void NeuralNetworkSimulation::reorderByLocality() {
+    const size_t n = neurons.size();
+    std::vector<std::pair<uint32_t, int>>& keys = reorderKeys;
+    keys.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& pos = neurons[i].getPosition();
+        auto qx = static_cast<uint32_t>(pos.x / std::max(width, 1.0) * 65535.0);
+        auto qy = static_cast<uint32_t>(pos.y / std::max(height, 1.0) * 65535.0);
+        keys[i] = {mortonKey(qx, qy), static_cast<int>(i)};
+    }
+    // 键相同时按原下标排序，结果与稳定排序相同（std::stable_sort 会申请临时缓冲区）
+    std::sort(keys.begin(), keys.end());
+    
+    std::vector<int>& oldToNew = reorderOldToNew;
+    oldToNew.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        oldToNew[keys[i].second] = static_cast<int>(i);
+    }
+    
+    // 这里有意复制而不是移动：复制会按新顺序重新分配各神经元的突触数组，使突触存储在堆上
+    // 也按空间顺序排列（移动时各神经元的堆块保持分散，信号传递反而变慢）。
+    // 复制保留原有的容量级别；这是稳态 step() 中唯一的一批堆分配，每 reorderInterval 步一次
+    std::vector<Neuron>& reordered = reorderNeurons;
+    std::vector<int>& newIndexToId = reorderIds;
+    newIndexToId.resize(n);
+    reordered.clear();
+    reordered.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        int old = keys[i].second;
+        const std::vector<Synapse>& source = neurons[old].getSynapses();
+        std::vector<Synapse> synapses;
+        synapses.reserve(source.capacity());
+        synapses.assign(source.begin(), source.end());
+        reordered.emplace_back(neurons[old].getState(), std::move(synapses));
+        reordered.back().remapTargets(oldToNew);
+        newIndexToId[i] = indexToId[old];
+        idToIndex[indexToId[old]] = static_cast<int>(i);
+    }
+    neurons.swap(reordered);
+    reordered.clear();   // 释放旧的突触数组，神经元数组本身的容量留给下次重排
+    indexToId.swap(newIndexToId);
+    
+    std::fill(inActiveSet.begin(), inActiveSet.end(), 0);
+    for (int& index : activeList) {
+        index = oldToNew[index];
+        inActiveSet[index] = 1;
+    }
+}
+
+void NeuralNetworkSimulation::traceSynapseUpdates(int index) {
+    // 在 updateSynapses() 之前调用，突触补算到上一步。与 Neuron::updateSynapses 的判断一致：
+    // 刚发放过的神经元增强全部活跃突触，超过 INACTIVITY_THRESHOLD 步未使用的突触失活
+    const Neuron& neuron = neurons[index];
+    const bool strengthen = neuron.strengthensAt(currentStep);
+    const int id = indexToId[index];
+    for (const auto& synapse : neuron.getSynapses()) {
+        if (!synapse.isActive) continue;
+        double strength = synapse.strengthAt(currentStep, params.decayRate);
+        if (strengthen) {
+            strength = std::min(Synapse::STRENGTH_MAX, strength + params.learningRate);
+            trace->record(currentStep, id, TraceEventType::SYNAPSE_STRENGTHEN, indexToId[synapse.targetNeuron],
+                          static_cast<float>(strength));
+        }
+        if (currentStep - synapse.lastUsed > Synapse::INACTIVITY_THRESHOLD) {
+            trace->record(currentStep, id, TraceEventType::SYNAPSE_DEACTIVATE, indexToId[synapse.targetNeuron],
+                          static_cast<float>(strength));
+        }
     }
 }
 
 void NeuralNetworkSimulation::step() {
     currentStep++;
+    const bool tracking = params.trackActiveSet;
+    if (tracking && activeSetStale) refreshActiveSet();
     
     // 移动所有神经元
     for (auto& neuron : neurons) {
-        neuron.move(width, height);
+        neuron.move(width, height, rng);
     }
     
     // 检查并建立新的连接
+    const double connectionThreshold = params.connectionThreshold;
     for (size_t i = 0; i < neurons.size(); ++i) {
         for (size_t j = 0; j < neurons.size(); ++j) {
             if (i != j && neurons[i].isCloseEnough(neurons[j], connectionThreshold)) {
                 double dist = distance(neurons[i].getPosition(), neurons[j].getPosition());
                 double strength = 0.5 + (0.5 * (1.0 - (dist / connectionThreshold)));
-                neurons[i].connectTo(j, strength, currentStep);
+                if (neurons[i].connectTo(j, strength, currentStep)) {
+                    if (trace) {
+                        trace->record(currentStep, indexToId[i], TraceEventType::SYNAPSE_CREATE, indexToId[j],
+                                      static_cast<float>(strength));
+                    }
+                }
             }
         }
     }
     
     // 处理神经元激活和信号传递
-    std::vector<int> firingNeurons;
-    for (size_t i = 0; i < neurons.size(); ++i) {
-        if (neurons[i].firing()) {
-            firingNeurons.push_back(static_cast<int>(i));
+    std::vector<int>& firingNeurons = firingScratch;
+    firingNeurons.clear();
+    if (tracking) {
+        // 正在发放的神经元一定在活跃集合中；按下标排序，使信号传递的顺序与逐个扫描时相同
+        for (int i : activeList) {
+            if (neurons[i].firing()) firingNeurons.push_back(i);
+        }
+        std::sort(firingNeurons.begin(), firingNeurons.end());
+    } else {
+        for (size_t i = 0; i < neurons.size(); ++i) {
+            if (neurons[i].firing()) {
+                firingNeurons.push_back(static_cast<int>(i));
+            }
         }
     }
     
+    // 追踪时记录两类发放：本步传出脉冲的神经元（外部刺激和上一步末的随机激活），
+    // 以及本步被突触输入推过阈值的神经元
     for (int source : firingNeurons) {
-        const auto& synapses = neurons[source].getActiveSynapses();
+        if (trace) {
+            trace->record(currentStep, indexToId[source], TraceEventType::FIRE, -1,
+                          static_cast<float>(neurons[source].getActivationLevel()));
+        }
+        const auto& synapses = neurons[source].getSynapses();
         for (const auto& synapse : synapses) {
+            if (!synapse.isActive) continue;
             int target = synapse.targetNeuron;
             double signal = synapse.strength * neurons[source].getActivationLevel();
-            neurons[target].receiveSignal(signal, currentStep);
+            if (trace && !neurons[target].firing()) {
+                neurons[target].receiveSignal(signal, currentStep);
+                if (neurons[target].firing()) {
+                    trace->record(currentStep, indexToId[target], TraceEventType::FIRE, -1, 1.0f);
+                }
+            } else {
+                neurons[target].receiveSignal(signal, currentStep);
+            }
+            if (tracking) markActive(target);
         }
     }
     
-    // 更新所有神经元状态
-    for (auto& neuron : neurons) {
-        neuron.update(currentStep);
+    // 更新神经元状态，两种方式的结果逐位相同。跟踪时只更新活跃集合：突触的衰减和失活
+    // 按闭式惰性补算，只有本步刚发放、需要增强突触的神经元才立即补算，其余神经元
+    // （包括全部静息的神经元）只在下面的随机激活循环中推进突触时钟。
+    // 不跟踪时逐个 update() 全部神经元并立即补算突触；两种方式都在之后做 settle() 的归零
+    auto updateStart = std::chrono::steady_clock::now();
+    if (trace) {
+        for (size_t i = 0; i < neurons.size(); ++i) traceSynapseUpdates(static_cast<int>(i));
     }
+    if (tracking) {
+        for (size_t k = 0; k < activeList.size();) {
+            int i = activeList[k];
+            neurons[i].updateDynamics(currentStep);
+            if (neurons[i].strengthensAt(currentStep)) {
+                neurons[i].updateSynapses(currentStep, params.learningRate, params.decayRate);
+            }
+            if (neurons[i].settle(ACTIVITY_EPSILON)) {
+                inActiveSet[i] = 0;
+                activeList[k] = activeList.back();
+                activeList.pop_back();
+            } else {
+                ++k;
+            }
+        }
+    } else {
+        for (auto& neuron : neurons) {
+            neuron.update(currentStep, params.learningRate, params.decayRate);
+            neuron.settle(ACTIVITY_EPSILON);
+        }
+        activeSetStale = true;
+    }
+    updateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - updateStart).count();
     
-    // 随机激活一些神经元
-    auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::mt19937 gen(seed);
+    // 随机激活一些神经元；顺带把所有神经元的突触时钟推进到本步（O(1)，不触碰突触）
     std::uniform_real_distribution<double> activationProb(0.0, 1.0);
-    const double ACTIVATION_CHANCE = 0.05;
     
-    for (auto& neuron : neurons) {
-        if (activationProb(gen) < ACTIVATION_CHANCE) {
-            neuron.fire(currentStep);
+    for (size_t i = 0; i < neurons.size(); ++i) {
+        neurons[i].advanceSynapseClock(currentStep, params.decayRate);
+        if (activationProb(rng) < params.activationChance) {
+            neurons[i].fire(currentStep);
+            if (tracking) markActive(static_cast<int>(i));
         }
     }
+    
+    // 定期按空间位置重排，保持信号传递时的访存局部性
+    if (reorderInterval > 0 && currentStep % reorderInterval == 0) {
+        reorderByLocality();
+    }
 }
 
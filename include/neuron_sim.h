@@ -3,6 +3,12 @@
 
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <algorithm>
+
+class TraceRecorder;
 
 // 向量类，用于表示位置和方向
 struct Vector2D {
@@ -19,11 +25,18 @@ struct Vector2D {
 double distance(const Vector2D& a, const Vector2D& b);
 
 // 突触类，表示神经元之间的连接
+//
+// 衰减是惰性的：两次增强之间强度只随时间线性衰减，第 t 步结束时为
+// max(STRENGTH_MIN, decayBase - (t - decayFrom) * 衰减率)，并在 inactiveFrom() 步失活。
+// 所属神经元在读取突触或增强前按这个闭式补算（见 Neuron::getSynapses），
+// 静息的神经元不必每步更新突触
 struct Synapse {
     int targetNeuron;  // 目标神经元的索引
-    double strength;   // 连接强度
-    double lastUsed;   // 最后使用时间
     bool isActive;     // 突触是否活跃
+    double strength;   // 连接强度（所属神经元最近一次补算时的值）
+    double lastUsed;   // 最后使用时间
+    double decayBase;  // 衰减起点的强度
+    double decayFrom;  // 衰减起点：decayBase 是第 decayFrom 步结束时的强度
     
     // 突触可塑性参数
     static const double STRENGTH_MIN;
@@ -32,25 +45,59 @@ struct Synapse {
     static const double DECAY_RATE;
     static const double INACTIVITY_THRESHOLD;  // 步数
     
-    Synapse(int target, double str, double initTime);
+    // decayFrom 为 str 对应的步（第 decayFrom 步结束时），之后每步衰减
+    Synapse(int target, double str, double initTime, double decayFrom);
+    Synapse(int target, double str, double initTime) : Synapse(target, str, initTime, initTime) {}
+    
+    // 按闭式计算第 t 步结束时的强度（t 不晚于失活的那一步）
+    double strengthAt(double t, double decayRate) const {
+        return std::max(STRENGTH_MIN, decayBase - std::max(0.0, t - decayFrom) * decayRate);
+    }
+    // 失活的那一步：第一个与 lastUsed 相差超过 INACTIVITY_THRESHOLD 的整数步
+    double inactiveFrom() const { return std::floor(lastUsed + INACTIVITY_THRESHOLD) + 1.0; }
+    // 在第 t 步结束时是否仍然活跃
+    bool activeAt(double t) const { return isActive && t < inactiveFrom(); }
     
-    void strengthen();
-    void decay();
+    void strengthen(double learningRate = LEARNING_RATE);
+    void decay(double decayRate = DECAY_RATE);
     void checkInactivity(double currentTime);
     void use(double currentTime);
 };
 
+// 神经元的可迁移状态（不含突触），用于在进程之间搬运神经元
+struct NeuronState {
+    Vector2D position;
+    Vector2D direction;
+    double speed;
+    double activationLevel;
+    double potential;
+    bool isFiring;
+    double lastFired;
+    double activationDecay;
+    double synapseClock;       // 突触已推进到的步（见 Neuron::advanceSynapseClock）
+    double synapseDecayRate;   // 自各突触衰减起点以来使用的衰减率
+};
+
 // 神经元类
 class Neuron {
 private:
     Vector2D position;    // 位置
     Vector2D direction;   // 移动方向
     double speed;         // 移动速度
-    std::vector<Synapse> synapses;  // 突触连接
+    // 突触连接。衰减和失活按闭式惰性补算：synapseClock 是突触状态应处的步，
+    // synapsesSyncedAt 是 synapses 中的 strength/isActive 实际补算到的步。
+    // 补算只改变缓存的结果，因此在 const 读取中进行
+    mutable std::vector<Synapse> synapses;
+    mutable double synapsesSyncedAt;
+    double synapseClock;
+    double synapseDecayRate;
     double activationLevel;  // 激活水平
     double potential;      // 膜电位
     bool isFiring;         // 是否正在发放脉冲
     
+    // 突触存储按大小级别（2的幂）扩容，失活的槽位会被新连接复用
+    static constexpr size_t SYNAPSE_BLOCK_MIN = 8;
+    
     // 神经元电生理参数
     static constexpr double RESTING_POTENTIAL = -70.0;
     static constexpr double THRESHOLD_POTENTIAL = -55.0;
@@ -59,46 +106,131 @@ private:
     double activationDecay; // 激活衰减率
     
 public:
-    Neuron(double x, double y);
+    // 初始方向和速度从 gen 中抽取
+    Neuron(double x, double y, std::mt19937& gen);
+    // 由迁移状态和突触列表恢复神经元：synapses 是第 state.synapseClock 步的状态，衰减起点原样保留
+    Neuron(const NeuronState& state, std::vector<Synapse> synapses);
+    
+    NeuronState getState() const;
     
     const Vector2D& getPosition() const;
     
-    void move(double width, double height);
+    void move(double width, double height, std::mt19937& gen);
     
-    void connectTo(int targetNeuron, double strength, double currentTime);
+    // 建立到目标的突触，已存在时不做任何事；新建时返回true。
+    // 新突触的强度对应当前的突触时钟，下一次推进时钟时开始衰减。不需要先补算：
+    // 已过失活步的突触按失活处理
+    bool connectTo(int targetNeuron, double strength, double currentTime);
     
     bool isCloseEnough(const Neuron& other, double threshold) const;
     
     std::vector<Synapse> getActiveSynapses() const;
     
+    // 直接访问突触存储（含已失活的空槽），热路径中避免复制。
+    // 以下读取都会先把衰减和失活补算到突触时钟，因此同一个神经元不能被多个线程同时读取
+    const std::vector<Synapse>& getSynapses() const;
+    size_t getActiveSynapseCount() const;
+    
+    // 把突触时钟推进到第 t 步，不触碰突触（O(1)）。衰减率改变时先按旧衰减率补算到
+    // 原时钟，并把各突触的衰减起点移到这里，之后按新衰减率计算
+    void advanceSynapseClock(double t, double decayRate);
+    // 把衰减和失活补算到突触时钟（已补算时立即返回）
+    void syncSynapses() const;
+    // 用 synapses 替换全部突触，其强度视为第 t 步结束时的值，从 t 开始按 decayRate 衰减
+    void replaceSynapses(const std::vector<Synapse>& synapses, double t, double decayRate);
+    
     void receiveSignal(double signalStrength, double currentTime);
     
     void fire(double currentTime);
     
-    void update(double currentTime);
+    // 一步的完整更新：updateDynamics + updateSynapses
+    void update(double currentTime,
+                double learningRate = Synapse::LEARNING_RATE,
+                double decayRate = Synapse::DECAY_RATE);
+    
+    // 激活衰减、电位泄漏、清除发放标志，不涉及突触
+    void updateDynamics(double currentTime);
     
-    void updateSynapses(double currentTime);
+    // 一步的突触更新：推进突触时钟并补算衰减/失活，本步刚发放时增强仍活跃的突触
+    // （增强后的强度成为新的衰减起点）
+    void updateSynapses(double currentTime,
+                        double learningRate = Synapse::LEARNING_RATE,
+                        double decayRate = Synapse::DECAY_RATE);
+    // 本步是否会增强突触（刚在第 currentTime 步发放过）
+    bool strengthensAt(double currentTime) const { return currentTime - lastFired < 1.0; }
+    
+    // 按 oldToNew 映射重写所有突触的目标索引（神经元重排后调用）
+    void remapTargets(const std::vector<int>& oldToNew);
+    
+    // 激活水平低于 epsilon 时归零，返回膜动力学是否已静息：电位不高于静息电位、
+    // 未在发放且激活水平为0，此时 updateDynamics() 不会改变任何状态
+    bool settle(double epsilon);
     
     bool firing() const;
     double getActivationLevel() const;
+    double getLastFired() const;
+};
+
+// 可在运行时调整的模拟参数
+struct SimulationParams {
+    double connectionThreshold = 90.0;               // 建立连接的距离阈值
+    double activationChance = 0.05;                  // 每步随机激活的概率
+    double learningRate = Synapse::LEARNING_RATE;    // 突触增强幅度
+    double decayRate = Synapse::DECAY_RATE;          // 突触衰减幅度
+    int trainSteps = 1000;                           // 每张训练图片运行的步数
+    uint64_t seed = 0;                               // 随机数种子，0表示按当前时间取种（每次运行不同）
+    bool trackActiveSet = true;                      // 每步只更新活跃集合中的神经元，false 时逐个更新全部神经元（结果相同）
 };
 
 // 神经网络模拟类
 class NeuralNetworkSimulation {
 public:
+    // 按下标存储的神经元。跟踪活跃集合时，step() 只更新活跃集合中的神经元，
+    // 因此不要在这里直接发放或注入信号：请用 stimulate()，或在直接修改（包括替换神经元）
+    // 之后调用 refreshActiveSet()。建立突触不影响活跃集合
     std::vector<Neuron> neurons;
     double width, height;
-    double connectionThreshold;
+    SimulationParams params;
     int currentStep;
+    int reorderInterval;   // 每隔多少步按空间位置重排一次神经元，0表示关闭
+    TraceRecorder* trace;  // 非空时记录发放和突触事件（见 event_trace.h）
+    double updateSeconds;  // step() 中更新神经元状态阶段的累计耗时（不含移动、连接和信号传递）
     
     NeuralNetworkSimulation(int numNeurons, double w, double h, double threshold);
+    NeuralNetworkSimulation(int numNeurons, double w, double h, const SimulationParams& params);
     
     void step();
     
+    // 神经元的外部ID在创建时确定且保持不变（输入层为前784个，输出层为最后10个），
+    // 而 neurons 中的下标会随重排变化，外部代码应通过ID访问固定的神经元
+    Neuron& neuronById(int id) { return neurons[idToIndex[id]]; }
+    const Neuron& neuronById(int id) const { return neurons[idToIndex[id]]; }
+    int indexOf(int id) const { return idToIndex[id]; }
+    int idOf(int index) const { return indexToId[index]; }
+    
+    // 按位置的Morton码对神经元排序并重映射突触目标，使空间上相邻的神经元在内存中也相邻
+    void reorderByLocality();
+    
+    // 重新设置随机数发生器，seed 为0时按当前时间取种。
+    // 复制出的网络共享同一随机序列，需要各自独立的随机性时（如并行副本）应分别重设
+    void reseed(uint64_t seed);
+    
+    // 外部刺激：外部ID为 id 的神经元发放，并加入活跃集合
+    void stimulate(int id);
+    
+    // 按外部ID建立突触（见 Neuron::connectTo）
+    bool connect(int id, int targetId, double strength, double currentTime);
+    
+    // 活跃集合只跟踪 step() 和 stimulate() 中的状态变化。绕过它们直接修改 neurons
+    // （发放、替换神经元等）之后需调用本函数，按当前状态重建活跃集合，并把所有神经元的
+    // 突触时钟推进到 currentStep
+    void refreshActiveSet();
+    size_t getActiveCount() const { return activeList.size(); }
+    
     size_t getTotalSynapses() const {
         size_t total = 0;
         for (const auto& neuron : neurons) {
-            total += neuron.getActiveSynapses().size();
+            total += neuron.getActiveSynapseCount();
         }
         return total;
     }
@@ -111,6 +243,39 @@ public:
         }
         return count;
     }
+
+private:
+    // 记录某个神经元在本步 update 中将发生的突触增强/失活事件
+    void traceSynapseUpdates(int index);
+
+    std::vector<int> idToIndex;   // 外部ID -> neurons下标
+    std::vector<int> indexToId;   // neurons下标 -> 外部ID
+    
+    // 活跃集合：可能在 update() 中改变状态的神经元（按 neurons 下标）。
+    // 神经元发放或收到信号时加入，updateDynamics() 后 settle() 判定为静息时移出。
+    // 突触不影响集合：其余神经元的突触只推进时钟，衰减和失活在读取时按闭式补算
+    static constexpr double ACTIVITY_EPSILON = 1e-6;   // 激活水平低于该值视为0
+    void markActive(int index) {
+        if (!inActiveSet[index]) {
+            inActiveSet[index] = 1;
+            activeList.push_back(index);
+        }
+    }
+    std::vector<int> activeList;
+    std::vector<uint8_t> inActiveSet;
+    bool activeSetStale;   // 关闭跟踪时运行过 step()，重新开启时需要重建
+    
+    // 网络自己的随机数发生器：初始位置、移动方向扰动和随机激活都从这里抽取，
+    // 固定 params.seed 时整个模拟可复现
+    std::mt19937 rng;
+    
+    // 每步复用的临时缓冲区，稳态下不再触发堆分配
+    std::vector<int> firingScratch;
+    // reorderByLocality 复用的缓冲区：排序键、下标映射，以及按新顺序复制神经元的数组
+    std::vector<std::pair<uint32_t, int>> reorderKeys;
+    std::vector<int> reorderOldToNew;
+    std::vector<int> reorderIds;
+    std::vector<Neuron> reorderNeurons;
 };
 
 #endif // NEURON_SIM_H
@@ -0,0 +1,33 @@
+#include "render_snapshot.h"
+
+void RenderSnapshot::capture(const NeuralNetworkSimulation& sim, bool buildIndex) {
+    const size_t n = sim.neurons.size();
+    step = sim.currentStep;
+    width = sim.width;
+    height = sim.height;
+    positions.resize(n);
+    activations.resize(n);
+    firing.resize(n);
+    ids.resize(n);
+    indexOfId.resize(n);
+    synapses.clear();
+
+    for (size_t i = 0; i < n; ++i) {
+        const auto& neuron = sim.neurons[i];
+        positions[i] = neuron.getPosition();
+        activations[i] = static_cast<float>(neuron.getActivationLevel());
+        firing[i] = neuron.firing() ? 1 : 0;
+        ids[i] = sim.idOf(i);
+        indexOfId[ids[i]] = static_cast<int>(i);
+        for (const auto& synapse : neuron.getSynapses()) {
+            if (synapse.isActive) {
+                synapses.push_back({static_cast<int>(i), synapse.targetNeuron,
+                                    static_cast<float>(synapse.strength), static_cast<float>(synapse.lastUsed)});
+            }
+        }
+    }
+
+    if (buildIndex) {
+        index.build(*this);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "neuron_sim.h"
+#include "synapse_index.h"
+
+// 快照中的一条活跃突触（source/target 为快照内的神经元下标）
+struct SnapshotSynapse {
+    int source, target;
+    float strength, lastUsed;
+};
+
+// 某一模拟步的只读渲染快照：绘制和悬停拾取只读快照，不访问正在运行的模拟
+struct RenderSnapshot {
+    int step = 0;
+    double width = 0, height = 0;
+    std::vector<Vector2D> positions;
+    std::vector<float> activations;
+    std::vector<uint8_t> firing;
+    std::vector<int> ids;                     // 下标 -> 神经元外部ID
+    std::vector<int> indexOfId;               // 神经元外部ID -> 下标（神经元重排后各快照的下标不同）
+    std::vector<SnapshotSynapse> synapses;
+    SynapseIndex index;                       // 突触线段的空间索引
+
+    // 从模拟复制状态（复用已有容量），buildIndex 为真时同时重建空间索引
+    void capture(const NeuralNetworkSimulation& sim, bool buildIndex = true);
+};
+
+// 单生产者/单消费者的无锁三缓冲：
+// 生产者写 back，publish() 与 middle 交换；消费者 update() 时若有新数据则与 middle 交换到 front。
+// 双方各自独占一个缓冲区，互不等待。
+template <typename T>
+class TripleBuffer {
+public:
+    // 生产者：当前可写的缓冲区
+    T& writeBuffer() { return buffers[back]; }
+
+    // 生产者：发布刚写好的缓冲区
+    void publish() {
+        int previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    // 消费者：取最新发布的缓冲区，有新数据时返回true
+    bool update() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        int previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX_MASK;
+        return true;
+    }
+
+    // 消费者：当前读取的缓冲区
+    const T& read() const { return buffers[front]; }
+
+private:
+    static constexpr int INDEX_MASK = 3;
+    static constexpr int FRESH = 4;
+
+    T buffers[3];
+    int front = 0;
+    int back = 2;
+    std::atomic<int> middle{1};
+};
+
+#endif // RENDER_SNAPSHOT_H
@@ -0,0 +1,349 @@
+#ifndef SPIKING_KERNEL_H
+#define SPIKING_KERNEL_H
+
+#include "neuron_sim.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// 编译期特化的脉冲动力学内核。
+//
+// 拓扑（突触表）在构造时从 NeuralNetworkSimulation 复制为CSR格式并保持不变，
+// 神经元状态按数组存储（SoA）。神经元模型、可塑性规则和标量类型都是模板参数，
+// 每种组合在编译期展开为独立内核，热循环内没有运行时分支，逐神经元/逐突触的循环可被自动向量化。
+// 神经元的移动和新连接的建立仍由 NeuralNetworkSimulation 负责。
+
+// 神经元状态数组，各模型按需使用其中的字段
+template <typename Scalar>
+struct NeuronArrays {
+    std::vector<Scalar> potential;   // 膜电位
+    std::vector<Scalar> recovery;    // 恢复变量（Izhikevich模型使用）
+    std::vector<Scalar> activation;  // 激活水平，决定发出信号的强度
+    std::vector<Scalar> lastFired;   // 上次发放时间
+    std::vector<Scalar> input;       // 本步累积的输入信号
+    std::vector<Scalar> firing;      // 是否正在发放（0/1，便于向量化）
+
+    void resize(size_t n) {
+        potential.resize(n);
+        recovery.resize(n);
+        activation.resize(n);
+        lastFired.resize(n);
+        input.assign(n, Scalar(0));
+        firing.assign(n, Scalar(0));
+    }
+};
+
+// CSR格式的突触表
+template <typename Scalar>
+struct SynapseTable {
+    std::vector<int> rowStart;   // 源神经元i的突触为 [rowStart[i], rowStart[i+1])
+    std::vector<int> target;
+    std::vector<Scalar> weight;
+};
+
+// ---------------------------------------------------------------------------
+// 神经元模型
+// ---------------------------------------------------------------------------
+
+// 与 Neuron 相同的泄漏积分发放模型：静息-70，阈值-55，不应期5步，输入增益×10
+template <typename Scalar>
+struct LifModel {
+    static constexpr Scalar RESTING_POTENTIAL = Scalar(-70.0);
+    static constexpr Scalar THRESHOLD_POTENTIAL = Scalar(-55.0);
+    static constexpr Scalar REFRACTORY_PERIOD = Scalar(5.0);
+    static constexpr Scalar SIGNAL_GAIN = Scalar(10.0);
+    static constexpr Scalar ACTIVATION_DECAY = Scalar(0.95);
+
+    static void reset(NeuronArrays<Scalar>& s, size_t i) {
+        s.potential[i] = RESTING_POTENTIAL;
+        s.recovery[i] = Scalar(0);
+        s.activation[i] = Scalar(0);
+        s.lastFired[i] = -REFRACTORY_PERIOD;
+    }
+
+    static void fire(NeuronArrays<Scalar>& s, size_t i, Scalar t) {
+        s.firing[i] = Scalar(1);
+        s.lastFired[i] = t;
+        s.activation[i] = Scalar(1);
+        s.potential[i] = RESTING_POTENTIAL;
+    }
+
+    // 对应 Neuron::receiveSignal：不应期内忽略输入，越过阈值立即发放
+    static void integrate(NeuronArrays<Scalar>& s, size_t n, Scalar t) {
+        Scalar* __restrict potential = s.potential.data();
+        Scalar* __restrict activation = s.activation.data();
+        Scalar* __restrict lastFired = s.lastFired.data();
+        Scalar* __restrict input = s.input.data();
+        Scalar* __restrict firing = s.firing.data();
+        for (size_t i = 0; i < n; ++i) {
+            bool receptive = input[i] > Scalar(0) && t - lastFired[i] >= REFRACTORY_PERIOD;
+            Scalar p = receptive ? potential[i] + input[i] * SIGNAL_GAIN : potential[i];
+            bool fires = receptive && p >= THRESHOLD_POTENTIAL;
+            potential[i] = fires ? RESTING_POTENTIAL : p;
+            activation[i] = fires ? Scalar(1) : activation[i];
+            lastFired[i] = fires ? t : lastFired[i];
+            firing[i] = fires ? Scalar(1) : firing[i];
+            input[i] = Scalar(0);
+        }
+    }
+
+    // 对应 Neuron::update：激活衰减、不应期外电位回落，并清除发放标志
+    static void update(NeuronArrays<Scalar>& s, size_t n, Scalar t) {
+        Scalar* __restrict potential = s.potential.data();
+        Scalar* __restrict activation = s.activation.data();
+        const Scalar* __restrict lastFired = s.lastFired.data();
+        Scalar* __restrict firing = s.firing.data();
+        for (size_t i = 0; i < n; ++i) {
+            activation[i] *= ACTIVATION_DECAY;
+            bool leaks = firing[i] == Scalar(0) && t - lastFired[i] >= REFRACTORY_PERIOD &&
+                         potential[i] > RESTING_POTENTIAL;
+            potential[i] = leaks ? potential[i] - Scalar(1) : potential[i];
+            firing[i] = Scalar(0);
+        }
+    }
+};
+
+// Izhikevich模型（规则发放参数 a=0.02 b=0.2 c=-65 d=8），输入同样乘以增益
+template <typename Scalar>
+struct IzhikevichModel {
+    static constexpr Scalar A = Scalar(0.02);
+    static constexpr Scalar B = Scalar(0.2);
+    static constexpr Scalar C = Scalar(-65.0);
+    static constexpr Scalar D = Scalar(8.0);
+    static constexpr Scalar PEAK = Scalar(30.0);
+    static constexpr Scalar SIGNAL_GAIN = Scalar(10.0);
+    static constexpr Scalar ACTIVATION_DECAY = Scalar(0.95);
+
+    static void reset(NeuronArrays<Scalar>& s, size_t i) {
+        s.potential[i] = C;
+        s.recovery[i] = B * C;
+        s.activation[i] = Scalar(0);
+        s.lastFired[i] = Scalar(-1e9);
+    }
+
+    static void fire(NeuronArrays<Scalar>& s, size_t i, Scalar t) {
+        s.firing[i] = Scalar(1);
+        s.lastFired[i] = t;
+        s.activation[i] = Scalar(1);
+        s.potential[i] = C;
+        s.recovery[i] += D;
+    }
+
+    // 输入在 update 中随微分方程一起积分
+    static void integrate(NeuronArrays<Scalar>&, size_t, Scalar) {}
+
+    static void update(NeuronArrays<Scalar>& s, size_t n, Scalar t) {
+        Scalar* __restrict v = s.potential.data();
+        Scalar* __restrict u = s.recovery.data();
+        Scalar* __restrict activation = s.activation.data();
+        Scalar* __restrict lastFired = s.lastFired.data();
+        Scalar* __restrict input = s.input.data();
+        Scalar* __restrict firing = s.firing.data();
+        for (size_t i = 0; i < n; ++i) {
+            Scalar current = input[i] * SIGNAL_GAIN;
+            Scalar vi = v[i], ui = u[i];
+            // 两个半步提高数值稳定性
+            vi += Scalar(0.5) * (Scalar(0.04) * vi * vi + Scalar(5) * vi + Scalar(140) - ui + current);
+            vi += Scalar(0.5) * (Scalar(0.04) * vi * vi + Scalar(5) * vi + Scalar(140) - ui + current);
+            ui += A * (B * vi - ui);
+            bool fires = vi >= PEAK;
+            v[i] = fires ? C : vi;
+            u[i] = fires ? ui + D : ui;
+            activation[i] = fires ? Scalar(1) : activation[i] * ACTIVATION_DECAY;
+            lastFired[i] = fires ? t : lastFired[i];
+            firing[i] = fires ? Scalar(1) : Scalar(0);
+            input[i] = Scalar(0);
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// 可塑性规则
+// ---------------------------------------------------------------------------
+
+// 可塑性规则的接口：
+//   init(state, n, params)   构造内核时调用，params 为模拟的运行时参数
+//   observe(state, s, n)     每步开始、信号传递之前调用，此时 s.firing 标记本步传出脉冲的神经元
+//   update(state, table, s, n, t)  神经元更新之后调整权重
+
+// 固定权重
+template <typename Scalar>
+struct NoPlasticity {
+    struct State {};
+    static void init(State&, size_t, const SimulationParams&) {}
+    static void observe(State&, const NeuronArrays<Scalar>&, size_t) {}
+    static void update(State&, SynapseTable<Scalar>&, const NeuronArrays<Scalar>&, size_t, Scalar) {}
+};
+
+// 与 Neuron::updateSynapses 相同的规则：每步衰减，源神经元刚发放过则增强，
+// 幅度取自模拟参数 learningRate / decayRate
+template <typename Scalar>
+struct DecayStrengthenPlasticity {
+    struct State {
+        Scalar learningRate = Scalar(Synapse::LEARNING_RATE);
+        Scalar decayRate = Scalar(Synapse::DECAY_RATE);
+    };
+    static void init(State& state, size_t, const SimulationParams& params) {
+        state.learningRate = Scalar(params.learningRate);
+        state.decayRate = Scalar(params.decayRate);
+    }
+    static void observe(State&, const NeuronArrays<Scalar>&, size_t) {}
+
+    static void update(State& state, SynapseTable<Scalar>& table, const NeuronArrays<Scalar>& s, size_t n, Scalar t) {
+        const Scalar lr = state.learningRate;
+        const Scalar decay = state.decayRate;
+        const Scalar wMin = Scalar(Synapse::STRENGTH_MIN);
+        const Scalar wMax = Scalar(Synapse::STRENGTH_MAX);
+        Scalar* __restrict weight = table.weight.data();
+        for (size_t i = 0; i < n; ++i) {
+            const Scalar boost = t - s.lastFired[i] < Scalar(1) ? lr : Scalar(0);
+            const int end = table.rowStart[i + 1];
+            for (int k = table.rowStart[i]; k < end; ++k) {
+                Scalar w = std::max(wMin, weight[k] - decay);
+                weight[k] = std::min(wMax, w + boost);
+            }
+        }
+    }
+};
+
+// 基于迹的STDP：突触前迹x和突触后迹y按指数衰减、发放时加1；
+// 突触后发放时按 A+·x_pre 增强，突触前发放时按 A-·y_post 削弱。
+// "发放"指本步实际传出脉冲（observe 时 firing 为1）：LIF模型中即外部刺激和随机激活，
+// 被输入推过阈值的发放在同一步的 update 中即被清除、不会传出，因此不计入
+template <typename Scalar>
+struct StdpPlasticity {
+    static constexpr Scalar TRACE_DECAY = Scalar(0.9);
+    static constexpr Scalar A_PLUS = Scalar(0.01);
+    static constexpr Scalar A_MINUS = Scalar(0.012);
+
+    struct State {
+        std::vector<Scalar> trace;   // 每个神经元一个迹，同时用作突触前和突触后迹
+        std::vector<Scalar> spiked;  // 本步是否传出脉冲（0/1）
+    };
+
+    static void init(State& state, size_t n, const SimulationParams&) {
+        state.trace.assign(n, Scalar(0));
+        state.spiked.assign(n, Scalar(0));
+    }
+
+    static void observe(State& state, const NeuronArrays<Scalar>& s, size_t n) {
+        std::copy(s.firing.begin(), s.firing.begin() + n, state.spiked.begin());
+    }
+
+    static void update(State& state, SynapseTable<Scalar>& table, const NeuronArrays<Scalar>&, size_t n, Scalar) {
+        const Scalar wMin = Scalar(Synapse::STRENGTH_MIN);
+        const Scalar wMax = Scalar(Synapse::STRENGTH_MAX);
+        Scalar* __restrict trace = state.trace.data();
+        const Scalar* __restrict spiked = state.spiked.data();
+        for (size_t i = 0; i < n; ++i) {
+            trace[i] = trace[i] * TRACE_DECAY + spiked[i];
+        }
+
+        Scalar* __restrict weight = table.weight.data();
+        const int* __restrict target = table.target.data();
+        for (size_t i = 0; i < n; ++i) {
+            const Scalar pre = trace[i];
+            const Scalar preSpiked = spiked[i];
+            const int end = table.rowStart[i + 1];
+            for (int k = table.rowStart[i]; k < end; ++k) {
+                const int j = target[k];
+                Scalar w = weight[k] + A_PLUS * pre * spiked[j] - A_MINUS * trace[j] * preSpiked;
+                weight[k] = std::min(wMax, std::max(wMin, w));
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// 内核
+// ---------------------------------------------------------------------------
+
+template <typename Scalar, template <typename> class NeuronModel, template <typename> class Plasticity>
+class SpikingKernel {
+public:
+    using Model = NeuronModel<Scalar>;
+    using Rule = Plasticity<Scalar>;
+
+    // 复制 sim 当前的活跃突触（按 neurons 下标），神经元从静息状态开始
+    explicit SpikingKernel(const NeuralNetworkSimulation& sim, uint64_t seed = 1)
+        : numNeurons(sim.neurons.size()),
+          activationChance(Scalar(sim.params.activationChance)),
+          rngState(seed ? seed : 1) {
+        table.rowStart.reserve(numNeurons + 1);
+        table.rowStart.push_back(0);
+        for (const auto& neuron : sim.neurons) {
+            for (const auto& synapse : neuron.getSynapses()) {
+                if (synapse.isActive) {
+                    table.target.push_back(synapse.targetNeuron);
+                    table.weight.push_back(Scalar(synapse.strength));
+                }
+            }
+            table.rowStart.push_back(static_cast<int>(table.target.size()));
+        }
+
+        state.resize(numNeurons);
+        for (size_t i = 0; i < numNeurons; ++i) {
+            Model::reset(state, i);
+        }
+        Rule::init(plasticityState, numNeurons, sim.params);
+    }
+
+    void stimulate(int index) { Model::fire(state, index, time); }
+
+    // 与 NeuralNetworkSimulation::step 相同的阶段顺序：传递 -> 积分 -> 更新 -> 可塑性 -> 随机激活
+    void step() {
+        time += Scalar(1);
+        Rule::observe(plasticityState, state, numNeurons);
+
+        const Scalar* __restrict firing = state.firing.data();
+        const Scalar* __restrict activation = state.activation.data();
+        Scalar* __restrict input = state.input.data();
+        for (size_t i = 0; i < numNeurons; ++i) {
+            if (firing[i] == Scalar(0)) continue;
+            const Scalar a = activation[i];
+            const int end = table.rowStart[i + 1];
+            for (int k = table.rowStart[i]; k < end; ++k) {
+                input[table.target[k]] += table.weight[k] * a;
+            }
+        }
+
+        Model::integrate(state, numNeurons, time);
+        Model::update(state, numNeurons, time);
+        Rule::update(plasticityState, table, state, numNeurons, time);
+
+        if (activationChance > Scalar(0)) {
+            const uint64_t limit = static_cast<uint64_t>(static_cast<double>(activationChance) * 4294967296.0);
+            for (size_t i = 0; i < numNeurons; ++i) {
+                if ((nextRandom() >> 32) < limit) {
+                    Model::fire(state, i, time);
+                }
+            }
+        }
+    }
+
+    Scalar getActivationLevel(int index) const { return state.activation[index]; }
+    Scalar getPotential(int index) const { return state.potential[index]; }
+    size_t getNeuronCount() const { return numNeurons; }
+    size_t getSynapseCount() const { return table.target.size(); }
+    const SynapseTable<Scalar>& getSynapses() const { return table; }
+
+private:
+    // xorshift64*，足够快且不需要每步重新播种
+    uint64_t nextRandom() {
+        rngState ^= rngState >> 12;
+        rngState ^= rngState << 25;
+        rngState ^= rngState >> 27;
+        return rngState * 0x2545F4914F6CDD1DULL;
+    }
+
+    size_t numNeurons;
+    Scalar activationChance;
+    Scalar time = Scalar(0);
+    uint64_t rngState;
+    SynapseTable<Scalar> table;
+    NeuronArrays<Scalar> state;
+    typename Rule::State plasticityState;
+};
+
+#endif // SPIKING_KERNEL_H
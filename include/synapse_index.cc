@@ -0,0 +1,141 @@
+#include "synapse_index.h"
+#include "render_snapshot.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+double point_to_segment_distance(double px, double py, double x1, double y1, double x2, double y2) {
+    // 向量计算：线段向量AB，点到A的向量AP
+    double ABx = x2 - x1;
+    double ABy = y2 - y1;
+    double APx = px - x1;
+    double APy = py - y1;
+
+    // 投影比例clamped到[0,1]（超出线段范围则取端点）
+    double dot_product = APx * ABx + APy * ABy;
+    double AB_length_sq = ABx * ABx + ABy * ABy;
+    double t = (AB_length_sq == 0) ? 0.0 : std::max(0.0, std::min(1.0, dot_product / AB_length_sq));
+
+    // 计算点到线段上最近点的距离
+    double dx = px - (x1 + t * ABx);
+    double dy = py - (y1 + t * ABy);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+SynapseIndex::SynapseIndex(double cellSize)
+    : cellSize(cellSize), cols(0), rows(0), queryStamp(0) {}
+
+template <typename F>
+void SynapseIndex::forEachCell(const Segment& s, F&& visit) const {
+    auto cellX = [this](double x) { return std::max(0, std::min(cols - 1, static_cast<int>(std::floor(x / cellSize)))); };
+    auto cellY = [this](double y) { return std::max(0, std::min(rows - 1, static_cast<int>(std::floor(y / cellSize)))); };
+
+    int cx = cellX(s.x1), cy = cellY(s.y1);
+    const int ex = cellX(s.x2), ey = cellY(s.y2);
+    const double dx = s.x2 - s.x1, dy = s.y2 - s.y1;
+    const int stepX = dx > 0 ? 1 : -1, stepY = dy > 0 ? 1 : -1;
+    const double inf = std::numeric_limits<double>::infinity();
+    double tMaxX = dx != 0 ? (((stepX > 0 ? cx + 1 : cx) * cellSize) - s.x1) / dx : inf;
+    double tMaxY = dy != 0 ? (((stepY > 0 ? cy + 1 : cy) * cellSize) - s.y1) / dy : inf;
+    const double tDeltaX = dx != 0 ? cellSize / std::fabs(dx) : inf;
+    const double tDeltaY = dy != 0 ? cellSize / std::fabs(dy) : inf;
+
+    // 最多经过的格子数，防止浮点误差导致越过终点
+    int remaining = std::abs(ex - cx) + std::abs(ey - cy);
+    visit(cy * cols + cx);
+    while (remaining-- > 0) {
+        if (tMaxX < tMaxY) {
+            cx += stepX;
+            tMaxX += tDeltaX;
+        } else {
+            cy += stepY;
+            tMaxY += tDeltaY;
+        }
+        cx = std::max(0, std::min(cols - 1, cx));
+        cy = std::max(0, std::min(rows - 1, cy));
+        visit(cy * cols + cx);
+    }
+}
+
+void SynapseIndex::build(const RenderSnapshot& snapshot) {
+    segments.clear();
+    for (const auto& synapse : snapshot.synapses) {
+        const auto& pos = snapshot.positions[synapse.source];
+        const auto& targetPos = snapshot.positions[synapse.target];
+        segments.push_back({static_cast<float>(pos.x), static_cast<float>(pos.y),
+                            static_cast<float>(targetPos.x), static_cast<float>(targetPos.y),
+                            synapse.source, synapse.target, synapse.strength, synapse.lastUsed});
+    }
+
+    cols = std::max(1, static_cast<int>(std::ceil(snapshot.width / cellSize)) + 1);
+    rows = std::max(1, static_cast<int>(std::ceil(snapshot.height / cellSize)) + 1);
+
+    // 两遍构建：先统计每个格子的线段数，再填充
+    cellStart.assign(static_cast<size_t>(cols) * rows + 1, 0);
+    for (const auto& s : segments) {
+        forEachCell(s, [this](int c) { cellStart[c + 1]++; });
+    }
+    for (size_t c = 1; c < cellStart.size(); ++c) {
+        cellStart[c] += cellStart[c - 1];
+    }
+    cellItems.resize(cellStart.back());
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (size_t k = 0; k < segments.size(); ++k) {
+        forEachCell(segments[k], [&](int c) { cellItems[fill[c]++] = static_cast<int>(k); });
+    }
+
+    visitedStamp.assign(segments.size(), 0);
+    queryStamp = 0;
+}
+
+bool SynapseIndex::query(double px, double py, double maxDistance, SynapseHit& hit) const {
+    if (segments.empty()) return false;
+    if (++queryStamp == 0) {
+        std::fill(visitedStamp.begin(), visitedStamp.end(), 0);
+        queryStamp = 1;
+    }
+
+    // 与查询圆相交的格子范围
+    int x0 = std::max(0, static_cast<int>(std::floor((px - maxDistance) / cellSize)));
+    int x1 = std::min(cols - 1, static_cast<int>(std::floor((px + maxDistance) / cellSize)));
+    int y0 = std::max(0, static_cast<int>(std::floor((py - maxDistance) / cellSize)));
+    int y1 = std::min(rows - 1, static_cast<int>(std::floor((py + maxDistance) / cellSize)));
+
+    // 返回最近的突触；一旦找到足够近的（阈值的1/4以内）就提前结束，
+    // 密集网络中鼠标附近有成千上万条线段，逐一比较没有意义
+    const double goodEnough = maxDistance * 0.25;
+    double best = maxDistance;
+    int bestIndex = -1;
+    auto scanCell = [&](int c) {
+        for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+            const int index = cellItems[k];
+            if (visitedStamp[index] == queryStamp) continue;
+            visitedStamp[index] = queryStamp;
+            const Segment& s = segments[index];
+            double d = point_to_segment_distance(px, py, s.x1, s.y1, s.x2, s.y2);
+            if (d < best) {
+                best = d;
+                bestIndex = index;
+                if (d < goodEnough) return true;
+            }
+        }
+        return false;
+    };
+
+    // 先查鼠标所在的格子，再查周围的格子
+    const int cx = static_cast<int>(std::floor(px / cellSize));
+    const int cy = static_cast<int>(std::floor(py / cellSize));
+    const bool centerInside = cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1;
+    bool done = centerInside && scanCell(cy * cols + cx);
+    for (int y = y0; y <= y1 && !done; ++y) {
+        for (int x = x0; x <= x1 && !done; ++x) {
+            if (centerInside && x == cx && y == cy) continue;
+            done = scanCell(y * cols + x);
+        }
+    }
+
+    if (bestIndex < 0) return false;
+    const Segment& s = segments[bestIndex];
+    hit = {s.source, s.target, s.strength, s.lastUsed, best};
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef SYNAPSE_INDEX_H
+#define SYNAPSE_INDEX_H
+
+#include <cstddef>
+#include <vector>
+
+struct RenderSnapshot;
+
+// 悬停拾取命中的突触
+struct SynapseHit {
+    int sourceNeuron;        // 源神经元索引
+    int targetNeuron;        // 目标神经元索引
+    double strength;         // 突触强度
+    double lastUsed;         // 最后使用时间
+    double distance;         // 查询点到突触线段的距离
+};
+
+// 计算点(px,py)到线段(x1,y1)-(x2,y2)的最短距离
+double point_to_segment_distance(double px, double py, double x1, double y1, double x2, double y2);
+
+// 突触线段的均匀网格索引：每个格子记录穿过它的线段，
+// 查询时只检查查询点附近格子中的线段。随每个渲染快照重建一次。
+class SynapseIndex {
+public:
+    explicit SynapseIndex(double cellSize = 32.0);
+
+    // 按快照中的神经元位置和突触重建索引
+    void build(const RenderSnapshot& snapshot);
+
+    // 查找距(px,py)不超过maxDistance的最近突触
+    bool query(double px, double py, double maxDistance, SynapseHit& hit) const;
+
+    size_t size() const { return segments.size(); }
+
+private:
+    struct Segment {
+        float x1, y1, x2, y2;
+        int source, target;
+        float strength, lastUsed;
+    };
+
+    // 按 Amanatides-Woo 算法遍历线段经过的所有格子
+    template <typename F>
+    void forEachCell(const Segment& s, F&& visit) const;
+
+    double cellSize;
+    int cols, rows;
+    std::vector<Segment> segments;
+    std::vector<int> cellStart;    // 格子c的线段为 cellItems[cellStart[c] .. cellStart[c+1])
+    std::vector<int> cellItems;
+    mutable std::vector<unsigned> visitedStamp;  // 查询时对跨多个格子的线段去重
+    mutable unsigned queryStamp;
+};
+
+#endif // SYNAPSE_INDEX_H
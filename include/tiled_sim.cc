@@ -0,0 +1,498 @@
+#include "tiled_sim.h"
+#include <atomic>
+#include <csignal>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// 边界区中的神经元位置
+struct HaloEntry {
+    int id;
+    double x, y;
+};
+
+// 跨进程投递的脉冲
+struct SpikeMessage {
+    int target;
+    double signal;
+};
+
+// 迁移记录头，后面紧跟 synapseCount 个 Synapse
+struct MigrationHeader {
+    int id;
+    int synapseCount;
+    NeuronState state;
+};
+
+// 每个块的接收通道头部
+struct ChannelHeader {
+    std::atomic<long long> spikeCount;
+    std::atomic<size_t> migrationBytes;
+    int haloCount;
+};
+
+// 共享内存布局：
+// [屏障][owner数组][每块统计][块0通道头 | 边界区 | 脉冲 | 迁移][块1通道 ...]
+// 区域大小按最坏情况预留，匿名映射只有被写到的页才会实际占用内存。
+class SharedLayout {
+public:
+    SharedLayout(const TiledSimulationConfig& config)
+        : numTiles(config.numTiles) {
+        const size_t n = config.numNeurons;
+        const size_t perTile = n / numTiles + 1;
+        haloCapacity = n;
+        spikeCapacity = std::max<size_t>(4096, perTile * 64);
+        migrationCapacity = std::max<size_t>(1 << 20, perTile * 1024);
+
+        ownerOffset = align(sizeof(pthread_barrier_t));
+        statsOffset = align(ownerOffset + n * sizeof(int));
+        channelOffset = align(statsOffset + numTiles * sizeof(TileStats));
+        haloOffset = align(sizeof(ChannelHeader));
+        spikeOffset = align(haloOffset + haloCapacity * sizeof(HaloEntry));
+        migrationOffset = align(spikeOffset + spikeCapacity * sizeof(SpikeMessage));
+        channelSize = align(migrationOffset + migrationCapacity);
+        totalSize = channelOffset + channelSize * numTiles;
+    }
+
+    bool map() {
+        void* mem = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mem == MAP_FAILED) return false;
+        base = static_cast<char*>(mem);
+        return true;
+    }
+
+    void unmap() {
+        if (base) munmap(base, totalSize);
+        base = nullptr;
+    }
+
+    pthread_barrier_t* barrier() const { return reinterpret_cast<pthread_barrier_t*>(base); }
+    int* owner() const { return reinterpret_cast<int*>(base + ownerOffset); }
+    TileStats* stats() const { return reinterpret_cast<TileStats*>(base + statsOffset); }
+    ChannelHeader* channel(int tile) const {
+        return reinterpret_cast<ChannelHeader*>(base + channelOffset + channelSize * tile);
+    }
+    HaloEntry* halo(int tile) const {
+        return reinterpret_cast<HaloEntry*>(reinterpret_cast<char*>(channel(tile)) + haloOffset);
+    }
+    SpikeMessage* spikes(int tile) const {
+        return reinterpret_cast<SpikeMessage*>(reinterpret_cast<char*>(channel(tile)) + spikeOffset);
+    }
+    char* migration(int tile) const {
+        return reinterpret_cast<char*>(channel(tile)) + migrationOffset;
+    }
+
+    int numTiles;
+    size_t haloCapacity, spikeCapacity, migrationCapacity;
+
+private:
+    static size_t align(size_t v) { return (v + 63) & ~static_cast<size_t>(63); }
+
+    char* base = nullptr;
+    size_t ownerOffset, statsOffset, channelOffset;
+    size_t haloOffset, spikeOffset, migrationOffset, channelSize, totalSize;
+};
+
+// 单个工作进程：拥有一个竖条内的神经元
+class TileWorker {
+public:
+    TileWorker(const TiledSimulationConfig& config, const SharedLayout& layout, int tile)
+        : config(config), layout(layout), tile(tile),
+          tileWidth(config.width / config.numTiles),
+          tileStart(tile * tileWidth), tileEnd((tile + 1) * tileWidth),
+          globalToLocal(config.numNeurons, -1),
+          gen(config.seed * 7919u + tile) {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    void run() {
+        createOwnedNeurons();
+        pthread_barrier_wait(layout.barrier());
+
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < config.steps; ++s) {
+            if (config.stimulusInterval > 0 && s % config.stimulusInterval == 0) stimulate();
+            currentStep++;
+            moveAndEmigrate();
+            pthread_barrier_wait(layout.barrier());
+            immigrateAndPublishHalo();
+            pthread_barrier_wait(layout.barrier());
+            connectAndPropagate();
+            pthread_barrier_wait(layout.barrier());
+            deliverAndUpdate();
+        }
+        pthread_barrier_wait(layout.barrier());
+        auto end = std::chrono::steady_clock::now();
+
+        stats.seconds = std::chrono::duration<double>(end - start).count();
+        stats.ownedNeurons = static_cast<int>(neurons.size());
+        for (const auto& neuron : neurons) {
+            stats.activeSynapses += neuron.getActiveSynapseCount();
+        }
+        layout.stats()[tile] = stats;
+    }
+
+private:
+    int tileOf(double x) const {
+        int t = static_cast<int>(x / tileWidth);
+        return std::max(0, std::min(config.numTiles - 1, t));
+    }
+
+    // 所有进程按 NeuralNetworkSimulation 构造函数的方式用同一种子生成全部神经元
+    // （位置、初始方向和速度都相同），各自只保留落在本块内的神经元
+    void createOwnedNeurons() {
+        std::seed_seq seq{static_cast<uint32_t>(config.seed), 0u};
+        std::mt19937 posGen(seq);
+        std::uniform_real_distribution<double> xDist(0, config.width);
+        std::uniform_real_distribution<double> yDist(0, config.height);
+        for (int id = 0; id < config.numNeurons; ++id) {
+            double x = xDist(posGen);
+            double y = yDist(posGen);
+            Neuron neuron(x, y, posGen);
+            if (tileOf(x) == tile) {
+                addLocal(id, std::move(neuron));
+                layout.owner()[id] = tile;
+            }
+        }
+    }
+
+    void stimulate() {
+        for (size_t i = 0; i < neurons.size(); ++i) {
+            if (ids[i] % config.stimulusStride == 0) neurons[i].fire(currentStep);
+        }
+    }
+
+    void addLocal(int id, Neuron neuron) {
+        globalToLocal[id] = static_cast<int>(neurons.size());
+        neurons.push_back(std::move(neuron));
+        ids.push_back(id);
+    }
+
+    void removeLocal(size_t index) {
+        globalToLocal[ids[index]] = -1;
+        if (index != neurons.size() - 1) {
+            neurons[index] = std::move(neurons.back());
+            ids[index] = ids.back();
+            globalToLocal[ids[index]] = static_cast<int>(index);
+        }
+        neurons.pop_back();
+        ids.pop_back();
+    }
+
+    // 把神经元写入目标块的迁移通道；通道已满时返回false，神经元留到下一步再迁移
+    bool sendMigration(int dest, size_t index) {
+        const Neuron& neuron = neurons[index];
+        int count = static_cast<int>(neuron.getActiveSynapseCount());
+        size_t size = (sizeof(MigrationHeader) + count * sizeof(Synapse) + 7) & ~static_cast<size_t>(7);
+
+        ChannelHeader* channel = layout.channel(dest);
+        size_t offset = channel->migrationBytes.load();
+        do {
+            if (offset + size > layout.migrationCapacity) return false;
+        } while (!channel->migrationBytes.compare_exchange_weak(offset, offset + size));
+
+        char* out = layout.migration(dest) + offset;
+        MigrationHeader header{ids[index], count, neuron.getState()};
+        std::memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        for (const auto& synapse : neuron.getSynapses()) {
+            if (synapse.isActive) {
+                std::memcpy(out, &synapse, sizeof(Synapse));
+                out += sizeof(Synapse);
+            }
+        }
+        layout.owner()[ids[index]] = dest;
+        return true;
+    }
+
+    void moveAndEmigrate() {
+        if (!config.moveNeurons) return;
+        for (size_t i = 0; i < neurons.size();) {
+            neurons[i].move(config.width, config.height, gen);
+            int dest = tileOf(neurons[i].getPosition().x);
+            if (dest != tile && sendMigration(dest, i)) {
+                stats.migrations++;
+                removeLocal(i);  // 末尾的神经元被换到i处，尚未移动，不递增i
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    void immigrateAndPublishHalo() {
+        ChannelHeader* channel = layout.channel(tile);
+        const char* in = layout.migration(tile);
+        const size_t total = channel->migrationBytes.load();
+        size_t offset = 0;
+        while (offset < total) {
+            MigrationHeader header;
+            std::memcpy(&header, in + offset, sizeof(header));
+            std::vector<Synapse> synapses(header.synapseCount, Synapse(0, 0.0, 0.0));
+            std::memcpy(synapses.data(), in + offset + sizeof(header), header.synapseCount * sizeof(Synapse));
+            addLocal(header.id, Neuron(header.state, std::move(synapses)));
+            offset += (sizeof(MigrationHeader) + header.synapseCount * sizeof(Synapse) + 7) & ~static_cast<size_t>(7);
+        }
+        channel->migrationBytes.store(0);
+
+        // 发布距块边界不足connectionThreshold的神经元
+        const double threshold = config.params.connectionThreshold;
+        HaloEntry* halo = layout.halo(tile);
+        int count = 0;
+        for (size_t i = 0; i < neurons.size(); ++i) {
+            const auto& pos = neurons[i].getPosition();
+            if (pos.x < tileStart + threshold || pos.x > tileEnd - threshold) {
+                if (static_cast<size_t>(count) < layout.haloCapacity) {
+                    halo[count++] = {ids[i], pos.x, pos.y};
+                } else {
+                    stats.haloOverflow++;
+                }
+            }
+        }
+        channel->haloCount = count;
+    }
+
+    // 候选神经元（本块 + 相邻块边界区）放入以connectionThreshold为边长的网格
+    void buildCandidateGrid() {
+        const double threshold = config.params.connectionThreshold;
+        candidates.clear();
+        for (size_t i = 0; i < neurons.size(); ++i) {
+            const auto& pos = neurons[i].getPosition();
+            candidates.push_back({ids[i], pos.x, pos.y});
+        }
+        for (int t = 0; t < config.numTiles; ++t) {
+            if (t == tile) continue;
+            double start = t * tileWidth, end = (t + 1) * tileWidth;
+            if (end < tileStart - threshold || start > tileEnd + threshold) continue;
+            const HaloEntry* halo = layout.halo(t);
+            const int count = layout.channel(t)->haloCount;
+            candidates.insert(candidates.end(), halo, halo + count);
+        }
+
+        gridX0 = tileStart - threshold;
+        gridCols = static_cast<int>((tileEnd + threshold - gridX0) / threshold) + 1;
+        gridRows = static_cast<int>(config.height / threshold) + 1;
+        cellStart.assign(gridCols * gridRows + 1, 0);
+        cellItems.resize(candidates.size());
+        for (const auto& c : candidates) cellStart[cellOf(c.x, c.y) + 1]++;
+        for (size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+        cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            cellItems[cellFill[cellOf(candidates[k].x, candidates[k].y)]++] = static_cast<int>(k);
+        }
+    }
+
+    int cellOf(double x, double y) const {
+        int cx = std::max(0, std::min(gridCols - 1, static_cast<int>((x - gridX0) / config.params.connectionThreshold)));
+        int cy = std::max(0, std::min(gridRows - 1, static_cast<int>(y / config.params.connectionThreshold)));
+        return cy * gridCols + cx;
+    }
+
+    void connectAndPropagate() {
+        const double threshold = config.params.connectionThreshold;
+        buildCandidateGrid();
+
+        // 检查并建立新的连接（与 NeuralNetworkSimulation::step 相同的强度公式）
+        for (size_t i = 0; i < neurons.size(); ++i) {
+            const auto& pos = neurons[i].getPosition();
+            int cell = cellOf(pos.x, pos.y);
+            int cx = cell % gridCols, cy = cell / gridCols;
+            for (int y = std::max(0, cy - 1); y <= std::min(gridRows - 1, cy + 1); ++y) {
+                for (int x = std::max(0, cx - 1); x <= std::min(gridCols - 1, cx + 1); ++x) {
+                    int c = y * gridCols + x;
+                    for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+                        const HaloEntry& other = candidates[cellItems[k]];
+                        if (other.id == ids[i]) continue;
+                        double dist = distance(pos, Vector2D(other.x, other.y));
+                        if (dist < threshold) {
+                            double strength = 0.5 + (0.5 * (1.0 - (dist / threshold)));
+                            neurons[i].connectTo(other.id, strength, currentStep);
+                        }
+                    }
+                }
+            }
+        }
+
+        // 信号传递：本块内直接投递，其他块写入目标所在块的脉冲通道
+        firing.clear();
+        for (size_t i = 0; i < neurons.size(); ++i) {
+            if (neurons[i].firing()) firing.push_back(static_cast<int>(i));
+        }
+        stats.fires += static_cast<long long>(firing.size());
+        for (int source : firing) {
+            double activation = neurons[source].getActivationLevel();
+            for (const auto& synapse : neurons[source].getSynapses()) {
+                if (!synapse.isActive) continue;
+                double signal = synapse.strength * activation;
+                int local = globalToLocal[synapse.targetNeuron];
+                if (local >= 0) {
+                    neurons[local].receiveSignal(signal, currentStep);
+                    stats.localSpikes++;
+                    continue;
+                }
+                int dest = layout.owner()[synapse.targetNeuron];
+                long long slot = layout.channel(dest)->spikeCount.fetch_add(1);
+                if (static_cast<size_t>(slot) < layout.spikeCapacity) {
+                    layout.spikes(dest)[slot] = {synapse.targetNeuron, signal};
+                    stats.remoteSpikes++;
+                } else {
+                    stats.droppedSpikes++;
+                }
+            }
+        }
+    }
+
+    void deliverAndUpdate() {
+        ChannelHeader* channel = layout.channel(tile);
+        const size_t count = std::min<size_t>(channel->spikeCount.load(), layout.spikeCapacity);
+        const SpikeMessage* spikes = layout.spikes(tile);
+        for (size_t k = 0; k < count; ++k) {
+            int local = globalToLocal[spikes[k].target];
+            if (local >= 0) {
+                neurons[local].receiveSignal(spikes[k].signal, currentStep);
+            }
+        }
+        channel->spikeCount.store(0);
+
+        const SimulationParams& params = config.params;
+        for (auto& neuron : neurons) {
+            if (neuron.getLastFired() == currentStep) stats.inducedFires++;
+            neuron.update(currentStep, params.learningRate, params.decayRate);
+        }
+
+        std::uniform_real_distribution<double> activationProb(0.0, 1.0);
+        for (auto& neuron : neurons) {
+            if (activationProb(gen) < params.activationChance) {
+                neuron.fire(currentStep);
+            }
+        }
+    }
+
+    const TiledSimulationConfig& config;
+    const SharedLayout& layout;
+    const int tile;
+    const double tileWidth, tileStart, tileEnd;
+    int currentStep = 0;
+
+    std::vector<Neuron> neurons;      // 本块拥有的神经元
+    std::vector<int> ids;             // 本地下标 -> 全局ID
+    std::vector<int> globalToLocal;   // 全局ID -> 本地下标（不在本块为-1）
+    std::mt19937 gen;
+    TileStats stats;
+
+    // 每步复用的临时缓冲区
+    std::vector<HaloEntry> candidates;
+    std::vector<int> cellStart, cellFill, cellItems;
+    std::vector<int> firing;
+    double gridX0 = 0;
+    int gridCols = 0, gridRows = 0;
+};
+
+} // namespace
+
+TiledSimulationResult runTiledSimulation(const TiledSimulationConfig& config) {
+    TiledSimulationResult result{};
+    if (config.numTiles < 1 || config.numNeurons < 1) {
+        std::cerr << "分块模拟参数无效" << std::endl;
+        return result;
+    }
+
+    SharedLayout layout(config);
+    if (!layout.map()) {
+        std::cerr << "无法分配共享内存" << std::endl;
+        return result;
+    }
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(layout.barrier(), &attr, config.numTiles);
+    pthread_barrierattr_destroy(&attr);
+    for (int t = 0; t < config.numTiles; ++t) {
+        ChannelHeader* channel = layout.channel(t);
+        new (&channel->spikeCount) std::atomic<long long>(0);
+        new (&channel->migrationBytes) std::atomic<size_t>(0);
+        channel->haloCount = 0;
+    }
+
+    std::vector<pid_t> workers;
+    for (int t = 0; t < config.numTiles; ++t) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            TileWorker(config, layout, t).run();
+            std::cout.flush();
+            _exit(0);
+        }
+        if (pid < 0) {
+            std::cerr << "无法创建工作进程" << std::endl;
+            // 已创建的进程会永远等在屏障上，只能终止它们
+            for (pid_t w : workers) kill(w, SIGKILL);
+            for (pid_t w : workers) waitpid(w, nullptr, 0);
+            layout.unmap();
+            return result;
+        }
+        workers.push_back(pid);
+    }
+
+    // 轮询各工作进程的退出状态：任一进程异常退出时，其余进程会永远等在屏障上，
+    // 此时终止全部剩余进程
+    result.ok = true;
+    std::vector<pid_t> running = workers;
+    while (!running.empty()) {
+        bool exited = false;
+        for (size_t k = 0; k < running.size();) {
+            int status = 0;
+            pid_t done = waitpid(running[k], &status, WNOHANG);
+            if (done == 0) {
+                ++k;
+                continue;
+            }
+            if (done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                std::cerr << "分块模拟工作进程 " << running[k] << " 异常退出"
+                          << (done > 0 && WIFSIGNALED(status) ? "（信号 " + std::to_string(WTERMSIG(status)) + "）" : "")
+                          << std::endl;
+                result.ok = false;
+            }
+            running[k] = running.back();
+            running.pop_back();
+            exited = true;
+        }
+        if (!result.ok) {
+            for (pid_t w : running) kill(w, SIGKILL);
+            for (pid_t w : running) waitpid(w, nullptr, 0);
+            break;
+        }
+        if (!exited) usleep(1000);
+    }
+
+    if (result.ok) {
+        for (int t = 0; t < config.numTiles; ++t) {
+            const TileStats& s = layout.stats()[t];
+            result.totalNeurons += s.ownedNeurons;
+            result.activeSynapses += s.activeSynapses;
+            result.localSpikes += s.localSpikes;
+            result.remoteSpikes += s.remoteSpikes;
+            result.droppedSpikes += s.droppedSpikes;
+            result.fires += s.fires;
+            result.inducedFires += s.inducedFires;
+            result.migrations += s.migrations;
+            result.haloOverflow += s.haloOverflow;
+            result.seconds = std::max(result.seconds, s.seconds);
+        }
+    }
+
+    // 被终止的进程可能还停在屏障中，此时 pthread_barrier_destroy 会一直等待它们离开，直接解除映射
+    if (result.ok) pthread_barrier_destroy(layout.barrier());
+    layout.unmap();
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef TILED_SIM_H
+#define TILED_SIM_H
+
+#include "neuron_sim.h"
+#include <cstddef>
+
+// 多进程分块模拟的配置：平面沿x方向切成 numTiles 个竖条，每个竖条由一个工作进程负责
+struct TiledSimulationConfig {
+    int numNeurons;
+    double width, height;
+    int numTiles;
+    int steps;
+    unsigned int seed;   // 初始位置的随机种子（所有工作进程生成同一组位置，与同种子的 NeuralNetworkSimulation 相同）
+    // 连接阈值、随机激活概率、学习率和衰减率；其中的 seed、trainSteps 和 trackActiveSet 不使用
+    SimulationParams params;
+    bool moveNeurons = true;    // false 时神经元不移动（也就没有迁移），用于确定性的对比
+    int stimulusInterval = 0;   // 大于0时每隔这么多步（在该步开始前）刺激ID为 stimulusStride 倍数的神经元，
+    int stimulusStride = 16;    // 与对 NeuralNetworkSimulation 在 step() 前调用 stimulate() 相同
+};
+
+// 单个工作进程的统计信息
+struct TileStats {
+    int ownedNeurons;           // 结束时拥有的神经元数
+    long long activeSynapses;   // 结束时的活跃突触数
+    long long localSpikes;      // 进程内投递的脉冲数
+    long long remoteSpikes;     // 发往其他进程的脉冲数
+    long long droppedSpikes;    // 因通道已满而丢弃的脉冲数
+    long long fires;            // 各步传出脉冲的神经元数之和
+    long long inducedFires;     // 被突触输入推过阈值的发放次数
+    long long migrations;       // 迁出的神经元数
+    long long haloOverflow;     // 因通道已满未能发布的边界神经元数
+    double seconds;             // 从第一步开始到最后一步结束的耗时
+};
+
+// 汇总结果
+struct TiledSimulationResult {
+    bool ok;                    // 所有工作进程是否正常退出
+    int totalNeurons;           // 各进程拥有神经元数之和（应等于numNeurons）
+    long long activeSynapses;
+    long long localSpikes;
+    long long remoteSpikes;
+    long long droppedSpikes;
+    long long fires;
+    long long inducedFires;
+    long long migrations;
+    long long haloOverflow;
+    double seconds;             // 最慢进程的耗时
+};
+
+// fork出 numTiles 个工作进程运行分块模拟，通过共享内存通道交换：
+// 1. 边界区（宽度为 params.connectionThreshold）的神经元位置，用于跨块建立连接
+// 2. 越过块边界的神经元（连同其突触）
+// 3. 目标位于其他块的脉冲
+// 突触的 targetNeuron 在分块模式中保存全局ID。
+TiledSimulationResult runTiledSimulation(const TiledSimulationConfig& config);
+
+#endif // TILED_SIM_H
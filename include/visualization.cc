@@ -1,32 +1,11 @@
 #include "visualization.h"
 #include <cmath>
 #include <sstream>
+#include <chrono>
 
-// 计算点(px,py)到线段(x1,y1)-(x2,y2)的最短距离
-double NeuronVisualization::point_to_line_distance(double px, double py, 
-                                                   double x1, double y1, 
-                                                   double x2, double y2) {
-    // 向量计算：线段向量AB，点到A的向量AP
-    double ABx = x2 - x1;
-    double ABy = y2 - y1;
-    double APx = px - x1;
-    double APy = py - y1;
-
-    // 计算AP在AB上的投影比例
-    double dot_product = APx * ABx + APy * ABy;
-    double AB_length_sq = ABx * ABx + ABy * ABy;
-
-    // 投影比例clamped到[0,1]（超出线段范围则取端点）
-    double t = (AB_length_sq == 0) ? 0.0 : std::max(0.0, std::min(1.0, dot_product / AB_length_sq));
-
-    // 线段上最近点的坐标
-    double closest_x = x1 + t * ABx;
-    double closest_y = y1 + t * ABy;
-
-    // 计算点到最近点的距离
-    double dx = px - closest_x;
-    double dy = py - closest_y;
-    return std::sqrt(dx * dx + dy * dy);
+namespace {
+    const int FRAME_INTERVAL_MS = 16;            // 界面刷新间隔（约60FPS）
+    const double PUBLISH_INTERVAL_S = 1.0 / 60;  // 全速运行时发布快照的最小间隔
 }
 
 // 更新并显示突触tooltip
@@ -39,8 +18,8 @@ void NeuronVisualization::show_synapse_tooltip(int x, int y) {
     // 构造突触信息文本（包含源/目标神经元、强度、最后使用时间）
     std::stringstream tooltip_text;
     tooltip_text << "突触信息:\n"
-                 << "源神经元: " << hoveredSynapse.sourceNeuron << "\n"
-                 << "目标神经元: " << hoveredSynapse.targetNeuron << "\n"
+                 << "源神经元: " << hoveredSynapse.sourceId << "\n"
+                 << "目标神经元: " << hoveredSynapse.targetId << "\n"
                  << "连接强度: " << std::fixed << std::setprecision(2) << hoveredSynapse.strength << "\n"
                  << "最后使用: 第" << static_cast<int>(hoveredSynapse.lastUsedStep) << "步";
 
@@ -64,47 +43,38 @@ void NeuronVisualization::hide_synapse_tooltip() {
     hoveredSynapse.isHovered = false;
 }
 
+// 在最近的鼠标位置拾取突触：只检查鼠标附近格子中的突触（使用当前显示的快照），
+// 命中的快照下标立即换成外部ID保存
+void NeuronVisualization::pick_synapse() {
+    const double HOVER_THRESHOLD = 8.0;  // 鼠标到突触的距离阈值（像素）
+    const RenderSnapshot& snapshot = snapshots.read();
+    SynapseHit hit;
+    if (snapshot.index.query(mouseX, mouseY, HOVER_THRESHOLD, hit)) {
+        hoveredSynapse.isHovered = true;
+        hoveredSynapse.sourceId = snapshot.ids[hit.sourceNeuron];
+        hoveredSynapse.targetId = snapshot.ids[hit.targetNeuron];
+        hoveredSynapse.strength = hit.strength;
+        hoveredSynapse.lastUsedStep = hit.lastUsed;
+
+        // 显示tooltip
+        show_synapse_tooltip(static_cast<int>(mouseRootX), static_cast<int>(mouseRootY));
+        return;
+    }
+
+    // 如果没有悬停在任何突触上，隐藏tooltip
+    hide_synapse_tooltip();
+}
+
 // 鼠标移动回调：检测悬停的突触
 gboolean NeuronVisualization::on_mouse_motion(GtkWidget* widget, GdkEventMotion* event, gpointer data) {
     NeuronVisualization* viz = static_cast<NeuronVisualization*>(data);
     if (!viz || !viz->simulation) return FALSE;
 
-    const double HOVER_THRESHOLD = 8.0;  // 鼠标到突触的距离阈值（像素）
-    viz->hoveredSynapse.isHovered = false;
-
-    // 遍历所有神经元的突触
-    for (size_t i = 0; i < viz->simulation->neurons.size(); ++i) {
-        const auto& neuron = viz->simulation->neurons[i];
-        const auto& synapses = neuron.getActiveSynapses();
-        const auto& pos = neuron.getPosition();
-
-        for (const auto& synapse : synapses) {
-            const auto& target_pos = viz->simulation->neurons[synapse.targetNeuron].getPosition();
-            
-            // 计算鼠标到突触线段的距离
-            double dist = viz->point_to_line_distance(
-                event->x, event->y,
-                pos.x, pos.y,
-                target_pos.x, target_pos.y
-            );
-
-            // 如果距离小于阈值，记录突触信息
-            if (dist < HOVER_THRESHOLD) {
-                viz->hoveredSynapse.isHovered = true;
-                viz->hoveredSynapse.sourceNeuron = static_cast<int>(i);
-                viz->hoveredSynapse.targetNeuron = synapse.targetNeuron;
-                viz->hoveredSynapse.strength = synapse.strength;
-                viz->hoveredSynapse.lastUsedStep = synapse.lastUsed;
-                
-                // 显示tooltip
-                viz->show_synapse_tooltip(static_cast<int>(event->x_root), static_cast<int>(event->y_root));
-                return TRUE;
-            }
-        }
-    }
-
-    // 如果没有悬停在任何突触上，隐藏tooltip
-    viz->hide_synapse_tooltip();
+    viz->mouseX = event->x;
+    viz->mouseY = event->y;
+    viz->mouseRootX = event->x_root;
+    viz->mouseRootY = event->y_root;
+    viz->pick_synapse();
     return TRUE;
 }
 
@@ -116,93 +86,101 @@ gboolean NeuronVisualization::draw_callback(GtkWidget* widget, cairo_t* cr, gpoi
     gint width = gtk_widget_get_allocated_width(widget);
     gint height = gtk_widget_get_allocated_height(widget);
     
-    // 绘制背景
-    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
-    cairo_paint(cr);
-    
-    // 绘制突触连接
-    for (size_t i = 0; i < viz->simulation->neurons.size(); ++i) {
-        const auto& neuron = viz->simulation->neurons[i];
-        const auto& synapses = neuron.getActiveSynapses();
-        const auto& pos = neuron.getPosition();
-        
-        for (const auto& synapse : synapses) {
-            const auto& targetPos = viz->simulation->neurons[synapse.targetNeuron].getPosition();
-            
-            // 突触强度决定线条透明度和宽度
-            double alpha = synapse.strength;
-            double lineWidth = 0.5 + (synapse.strength * 1.5);
-            
-            // 如果是当前悬停的突触，高亮显示
-            if (viz->hoveredSynapse.isHovered &&
-                viz->hoveredSynapse.sourceNeuron == static_cast<int>(i) &&
-                viz->hoveredSynapse.targetNeuron == synapse.targetNeuron) {
-                cairo_set_source_rgba(cr, 1.0, 1.0, 0.0, 1.0);  // 黄色高亮
-                cairo_set_line_width(cr, lineWidth + 1.0);       // 线宽增加
-            } else {
-                cairo_set_source_rgba(cr, 0.5, 0.8, 1.0, alpha); // 普通蓝色
-                cairo_set_line_width(cr, lineWidth);
-            }
-            
-            cairo_move_to(cr, pos.x, pos.y);
-            cairo_line_to(cr, targetPos.x, targetPos.y);
-            cairo_stroke(cr);
-        }
-    }
-    
-    // 绘制神经元
-    for (const auto& neuron : viz->simulation->neurons) {
-        const auto& pos = neuron.getPosition();
-        double activation = neuron.getActivationLevel();
-        
-        // 激活水平决定颜色
-        if (neuron.firing()) {
-            // 正在发放的神经元显示为红色
-            cairo_set_source_rgb(cr, 1.0, 0.2, 0.2);
-        } else {
-            // 激活水平高的神经元显示为更亮的蓝色
-            cairo_set_source_rgb(cr, 0.3, 0.5 + activation * 0.5, 1.0);
-        }
-        
-        // 绘制神经元主体
-        double radius = 5.0 + (activation * 3.0);
-        cairo_arc(cr, pos.x, pos.y, radius, 0, 2 * G_PI);
-        cairo_fill(cr);
-        
-        // 绘制神经元边框
-        cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
-        cairo_set_line_width(cr, 1.0);
-        cairo_arc(cr, pos.x, pos.y, radius, 0, 2 * G_PI);
-        cairo_stroke(cr);
-    }
+    viz->renderer.render(cr, viz->snapshots.read(), width, height, &viz->hoveredSynapse);
+    viz->framesDrawn++;
+
+    // 左上角显示模拟速度和渲染帧率
+    std::stringstream stats;
+    stats << "模拟 " << std::fixed << std::setprecision(0) << viz->stepsPerSecond << " 步/秒 | "
+          << "渲染 " << std::setprecision(1) << viz->framesPerSecond << " FPS | "
+          << "帧耗时 " << std::setprecision(2) << viz->renderer.getLastFrameMs() << " ms | "
+          << "第 " << viz->snapshots.read().step << " 步";
+    cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 13.0);
+    cairo_move_to(cr, 10, 20);
+    cairo_show_text(cr, stats.str().c_str());
     
     return FALSE;
 }
 
-// 模拟更新回调函数实现
+// 界面刷新回调函数实现：只在有新快照时重绘
 gboolean NeuronVisualization::update_simulation(gpointer data) {
     NeuronVisualization* viz = static_cast<NeuronVisualization*>(data);
-    if (!viz || !viz->running || !viz->simulation) return FALSE;
-    
-    viz->simulation->step();
-    
-    // 重绘窗口
-    gtk_widget_queue_draw(viz->drawing_area);
+    if (!viz) return FALSE;
+    if (!viz->running) {
+        viz->update_timer = 0;
+        return FALSE;
+    }
+
+    gint64 now = g_get_monotonic_time();
+    double elapsed = (now - viz->statsStartTime) / 1e6;
+    if (elapsed >= 1.0) {
+        long steps = viz->stepsCompleted.load(std::memory_order_relaxed);
+        viz->stepsPerSecond = (steps - viz->statsStartSteps) / elapsed;
+        viz->framesPerSecond = viz->framesDrawn / elapsed;
+        viz->statsStartTime = now;
+        viz->statsStartSteps = steps;
+        viz->framesDrawn = 0;
+    }
+
+    if (viz->snapshots.update()) {
+        // 换了快照：旧的悬停信息可能已失效（突触失活或移开），在原鼠标位置重新拾取
+        if (viz->hoveredSynapse.isHovered) viz->pick_synapse();
+        // 重绘窗口
+        gtk_widget_queue_draw(viz->drawing_area);
+    }
     
     return TRUE;
 }
 
+// 工作线程：不受界面帧率限制地执行模拟步
+void NeuronVisualization::simulation_loop() {
+    using clock = std::chrono::steady_clock;
+    auto lastPublish = clock::now();
+    auto nextStep = lastPublish;
+
+    while (running.load(std::memory_order_relaxed)) {
+        simulation->step();
+        stepsCompleted.fetch_add(1, std::memory_order_relaxed);
+
+        // 全速运行时按显示帧率发布快照，避免把时间花在没人看的快照上
+        auto now = clock::now();
+        if (std::chrono::duration<double>(now - lastPublish).count() >= PUBLISH_INTERVAL_S) {
+            snapshots.writeBuffer().capture(*simulation);
+            snapshots.publish();
+            lastPublish = now;
+        }
+
+        double rate = stepRate.load(std::memory_order_relaxed);
+        if (rate > 0) {
+            nextStep += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate));
+            if (nextStep < now) nextStep = now;
+            std::this_thread::sleep_until(nextStep);
+        }
+    }
+}
+
+void NeuronVisualization::stop_simulation() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
 // 窗口关闭回调函数实现
 void NeuronVisualization::on_window_closed(GtkWidget* widget, gpointer data) {
     NeuronVisualization* viz = static_cast<NeuronVisualization*>(data);
     if (viz) {
-        viz->running = FALSE;
+        viz->stop_simulation();
+        gtk_main_quit();
     }
 }
 
 // 构造函数实现
 NeuronVisualization::NeuronVisualization(NeuralNetworkSimulation* sim, int width, int height)
-    : simulation(sim), running(FALSE), update_timer(0) {
+    : simulation(sim), running(false), update_timer(0), stepRate(0.0), stepsCompleted(0),
+      statsStartTime(0), statsStartSteps(0), framesDrawn(0), stepsPerSecond(0.0), framesPerSecond(0.0) {
     // 初始化GTK窗口
     window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(window), "神经元网络模拟");
@@ -235,12 +213,19 @@ NeuronVisualization::NeuronVisualization(NeuralNetworkSimulation* sim, int width
     
     // 初始化悬停信息
     hoveredSynapse.isHovered = false;
-    hoveredSynapse.sourceNeuron = -1;
-    hoveredSynapse.targetNeuron = -1;
+    hoveredSynapse.sourceId = -1;
+    hoveredSynapse.targetId = -1;
+    mouseX = mouseY = mouseRootX = mouseRootY = 0;
+
+    // 工作线程启动前先发布初始状态
+    snapshots.writeBuffer().capture(*simulation);
+    snapshots.publish();
+    snapshots.update();
 }
 
 // 析构函数实现
 NeuronVisualization::~NeuronVisualization() {
+    stop_simulation();
     if (update_timer) {
         g_source_remove(update_timer);
     }
@@ -248,9 +233,13 @@ NeuronVisualization::~NeuronVisualization() {
 
 // 运行主循环
 void NeuronVisualization::run() {
-    running = TRUE;
-    // 设置定时器，每50毫秒更新一次模拟
-    update_timer = g_timeout_add(50, update_simulation, this);
+    running = true;
+    statsStartTime = g_get_monotonic_time();
+    statsStartSteps = stepsCompleted.load();
+    worker = std::thread(&NeuronVisualization::simulation_loop, this);
+
+    // 界面定时器只负责取快照和重绘，不执行模拟
+    update_timer = g_timeout_add(FRAME_INTERVAL_MS, update_simulation, this);
     
     // 显示所有控件
     gtk_widget_show_all(window);
@@ -3,16 +3,11 @@
 
 #include <gtk/gtk.h>
 #include <iomanip>
+#include <atomic>
+#include <thread>
 #include "neuron_sim.h"
-
-// 存储当前悬停的突触信息
-struct HoveredSynapseInfo {
-    bool isHovered;          // 是否悬停在突触上
-    int sourceNeuron;        // 源神经元索引
-    int targetNeuron;        // 目标神经元索引
-    double strength;         // 突触强度
-    double lastUsedStep;     // 最后使用的模拟步数
-};
+#include "network_renderer.h"
+#include "render_snapshot.h"
 
 class NeuronVisualization {
 public:
@@ -20,8 +15,10 @@ public:
     NeuronVisualization(NeuralNetworkSimulation* sim, int width, int height);
     // 析构函数：释放资源
     ~NeuronVisualization();
-    // 运行GUI主循环
+    // 运行GUI主循环（模拟在独立的工作线程中运行）
     void run();
+    // 设置模拟速率（步/秒），0表示全速运行
+    void setStepRate(double stepsPerSecond) { stepRate = stepsPerSecond; }
 
 private:
     NeuralNetworkSimulation* simulation;  // 神经元模拟对象指针
@@ -29,23 +26,41 @@ private:
     GtkWidget* drawing_area;              // 绘图区域
     GtkWidget* tooltip_window;            // 突触信息提示窗口
     GtkWidget* tooltip_label;             // 提示窗口中的文本标签
-    bool running;                         // 模拟是否正在运行
-    guint update_timer;                   // 模拟更新定时器ID
-    HoveredSynapseInfo hoveredSynapse;    // 当前悬停的突触信息
+    std::atomic<bool> running;            // 模拟是否正在运行
+    guint update_timer;                   // 界面刷新定时器ID
+    HoveredSynapseInfo hoveredSynapse;    // 当前悬停的突触信息（神经元外部ID）
+    double mouseX, mouseY;                // 最近一次鼠标位置（绘图区坐标和屏幕坐标），
+    double mouseRootX, mouseRootY;        // 换到新快照时在这里重新拾取
+    NetworkRenderer renderer;             // 批量绘制神经元和突触
+
+    // 模拟线程只写三缓冲的后台缓冲区，界面线程只读前台缓冲区，二者不共享可变状态
+    std::thread worker;                   // 模拟工作线程
+    std::atomic<double> stepRate;         // 目标模拟速率，0表示全速
+    std::atomic<long> stepsCompleted;     // 工作线程已完成的步数
+    TripleBuffer<RenderSnapshot> snapshots;
+
+    // 界面上显示的统计，每秒更新一次
+    gint64 statsStartTime;
+    long statsStartSteps;
+    int framesDrawn;
+    double stepsPerSecond;
+    double framesPerSecond;
 
     // 绘图回调函数：绘制神经元和突触
     static gboolean draw_callback(GtkWidget* widget, cairo_t* cr, gpointer data);
-    // 模拟更新回调函数：每帧更新模拟状态
+    // 界面刷新回调函数：取最新快照并请求重绘
     static gboolean update_simulation(gpointer data);
+    // 工作线程：循环执行模拟步并发布快照
+    void simulation_loop();
+    // 停止并等待工作线程
+    void stop_simulation();
     // 窗口关闭回调函数：停止模拟
     static void on_window_closed(GtkWidget* widget, gpointer data);
     // 鼠标移动回调函数：检测是否悬停在突触上
     static gboolean on_mouse_motion(GtkWidget* widget, GdkEventMotion* event, gpointer data);
     
-    // 辅助函数：计算点到线段的距离（判断鼠标是否靠近突触）
-    double point_to_line_distance(double px, double py, 
-                                 double x1, double y1, 
-                                 double x2, double y2);
+    // 在最近的鼠标位置对当前快照拾取突触，更新或清除悬停信息和tooltip
+    void pick_synapse();
     // 辅助函数：更新tooltip内容并显示
     void show_synapse_tooltip(int x, int y);
     // 辅助函数：隐藏tooltip
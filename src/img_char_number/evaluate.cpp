@@ -0,0 +1,213 @@
+#include "neuron_sim.h"
+#include "img_char_number.h"
+#include "inference.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <optional>
+#include <sys/resource.h>
+
+// 批量评估训练结果：模型只加载一次，多线程识别整个数据集，输出混淆矩阵、
+// 各数字准确率、吞吐量、单张延迟分位数和峰值内存
+// 数据集（三选一，默认 --holdout）：
+//   --holdout           训练目录的留出集（与 sweep 相同的划分）。模型须由 train 默认方式（只用训练集）
+//                       或合成样本训练，文件尾未记录或训练时包含留出集的模型会被拒绝
+//   --dir 目录          目录下 0/ .. 9/ 中的所有PNG
+//   --pack 文件         打包的数据集（见 save_digit_pack）
+// 其他选项：
+//   --model 文件        模型路径，默认 DIGIT_MODEL_PATH
+//   --threads N         识别线程数，默认为硬件线程数
+//   --per-digit N       每个数字最多评估 N 张
+//   --fixed             使用定点推理引擎（默认与 recognize 相同，每张图片在模型副本上运行 recognize_digit）
+//   --write-pack 文件   把加载的图片写成打包的数据集后退出
+//   --allow-overlap     留出集评估时接受训练时可能包含留出集的模型，结果标为训练集准确率
+
+using Clock = std::chrono::steady_clock;
+
+struct EvalResult {
+    int predicted = -1;
+    double latencyMs = 0;
+};
+
+static void print_usage(const char* program) {
+    std::cerr << "用法: " << program << " [--holdout | --dir 目录 | --pack 文件] [--model 文件] [--threads N]"
+              << " [--per-digit N] [--fixed] [--write-pack 文件] [--allow-overlap]" << std::endl;
+}
+
+// 工作线程从共享计数器领取图片，结果按图片下标写入
+static void evaluate_worker(const NeuralNetworkSimulation& model, bool useFixed, uint64_t seed,
+                            const std::vector<DigitImage>& images, std::atomic<size_t>& next,
+                            std::vector<EvalResult>& results) {
+    // 定点引擎带有运行状态，每个线程构建自己的一份
+    std::optional<InferenceEngine> engine;
+    if (useFixed) engine.emplace(model, 0.0, seed);
+
+    for (size_t i = next++; i < images.size(); i = next++) {
+        auto start = Clock::now();
+        if (engine) {
+            results[i].predicted = engine->recognize(images[i].img);
+        } else {
+            NeuralNetworkSimulation copy = model;
+            results[i].predicted = recognize_digit(copy, images[i].img);
+        }
+        results[i].latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+int main(int argc, char* argv[]) {
+    std::string modelPath = DIGIT_MODEL_PATH;
+    std::string dir, packPath, writePackPath;
+    bool useFixed = false;
+    bool allowOverlap = false;
+    size_t perDigit = 0;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--holdout") {
+            dir.clear();
+            packPath.clear();
+        } else if (arg == "--dir" && hasValue) {
+            dir = argv[++i];
+        } else if (arg == "--pack" && hasValue) {
+            packPath = argv[++i];
+        } else if (arg == "--model" && hasValue) {
+            modelPath = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--per-digit" && hasValue) {
+            perDigit = std::stoul(argv[++i]);
+        } else if (arg == "--fixed") {
+            useFixed = true;
+        } else if (arg == "--write-pack" && hasValue) {
+            writePackPath = argv[++i];
+        } else if (arg == "--allow-overlap") {
+            allowOverlap = true;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // 加载数据集
+    auto loadStart = Clock::now();
+    std::vector<DigitImage> images;
+    std::string source;
+    if (!packPath.empty()) {
+        if (!load_digit_pack(images, packPath)) return 1;
+        if (perDigit > 0) {
+            std::vector<size_t> count(DIGIT_COUNT, 0);
+            images.erase(std::remove_if(images.begin(), images.end(),
+                                        [&](const DigitImage& image) { return count[image.digit]++ >= perDigit; }),
+                         images.end());
+        }
+        source = packPath;
+    } else if (!dir.empty()) {
+        images = load_digit_images(list_digit_samples(dir), perDigit);
+        source = dir;
+    } else {
+        std::vector<DigitSample> train, holdout;
+        split_digit_samples(list_digit_samples(DIGIT_TRAIN_DIR), train, holdout);
+        images = load_digit_images(holdout, perDigit);
+        source = std::string(DIGIT_TRAIN_DIR) + "（留出集）";
+    }
+    double loadSeconds = std::chrono::duration<double>(Clock::now() - loadStart).count();
+    if (images.empty()) {
+        std::cerr << "没有可评估的图片: " << source << std::endl;
+        return 1;
+    }
+
+    if (!writePackPath.empty()) {
+        if (!save_digit_pack(images, writePackPath)) return 1;
+        std::cout << "已写入 " << images.size() << " 张图片: " << writePackPath << std::endl;
+        return 0;
+    }
+
+    // 留出集评估只对没见过留出集的模型有意义
+    const bool holdout = packPath.empty() && dir.empty();
+    if (holdout) {
+        TrainingData data = read_training_data(modelPath);
+        if (data != TrainingData::TRAIN_SPLIT && data != TrainingData::SYNTHETIC) {
+            std::cerr << (data == TrainingData::ALL_IMAGES ? "模型训练时使用了包括留出集在内的全部图片"
+                                                           : "模型没有记录训练数据（旧模型或由其他程序保存）")
+                      << ": " << modelPath << std::endl;
+            if (!allowOverlap) {
+                std::cerr << "留出集准确率可能就是训练集准确率。请用 train（不加 --all-images）重新训练，"
+                          << "或加 --allow-overlap 仍然评估" << std::endl;
+                return 1;
+            }
+            source += "（模型可能见过这些图片，结果为训练集准确率）";
+        }
+    }
+
+    // 加载模型（只加载一次，各线程共享只读的模型）
+    NeuralNetworkSimulation model(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, DIGIT_THRESHOLD);
+    if (!load_training_result(model, modelPath)) return 1;
+
+    threads = std::min<int>(threads, static_cast<int>(images.size()));
+    std::cout << "数据集: " << source << "  图片: " << images.size() << "  加载: " << std::fixed
+              << std::setprecision(2) << loadSeconds << " s" << std::endl;
+    std::cout << "模型: " << modelPath << "  突触: " << model.getTotalSynapses() << "  识别: "
+              << (useFixed ? "定点引擎" : "recognize_digit") << "  线程: " << threads << std::endl << std::endl;
+
+    std::vector<EvalResult> results(images.size());
+    std::atomic<size_t> next{0};
+    auto evalStart = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(evaluate_worker, std::cref(model), useFixed, static_cast<uint64_t>(t + 1),
+                             std::cref(images), std::ref(next), std::ref(results));
+    }
+    for (auto& worker : workers) worker.join();
+    double evalSeconds = std::chrono::duration<double>(Clock::now() - evalStart).count();
+
+    // 混淆矩阵：行为真实数字，列为识别结果
+    std::vector<std::vector<int>> confusion(DIGIT_COUNT, std::vector<int>(DIGIT_COUNT, 0));
+    std::vector<double> latencies;
+    int correct = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        int predicted = results[i].predicted;
+        if (predicted >= 0 && predicted < DIGIT_COUNT) confusion[images[i].digit][predicted]++;
+        if (predicted == images[i].digit) correct++;
+        latencies.push_back(results[i].latencyMs);
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "混淆矩阵（行: 真实, 列: 识别）" << std::endl << "    ";
+    for (int d = 0; d < DIGIT_COUNT; ++d) std::cout << std::setw(5) << d;
+    std::cout << "   准确率" << std::endl;
+    for (int d = 0; d < DIGIT_COUNT; ++d) {
+        int total = 0;
+        std::cout << std::setw(4) << d;
+        for (int p = 0; p < DIGIT_COUNT; ++p) {
+            std::cout << std::setw(5) << confusion[d][p];
+            total += confusion[d][p];
+        }
+        std::cout << std::setw(9) << std::setprecision(3)
+                  << (total > 0 ? static_cast<double>(confusion[d][d]) / total : 0.0) << std::endl;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << std::endl << "准确率: " << std::setprecision(4) << static_cast<double>(correct) / images.size()
+              << "（" << correct << "/" << images.size() << "）" << std::endl;
+    std::cout << "吞吐量: " << std::setprecision(2) << images.size() / evalSeconds << " 图片/秒（"
+              << evalSeconds << " s）" << std::endl;
+    std::cout << "单张延迟(ms): p50 " << std::setprecision(3) << percentile(latencies, 0.50)
+              << "  p90 " << percentile(latencies, 0.90) << "  p99 " << percentile(latencies, 0.99)
+              << "  max " << latencies.back() << std::endl;
+    std::cout << "峰值内存: " << std::setprecision(1) << usage.ru_maxrss / 1024.0 << " MB" << std::endl;
+    return 0;
+}
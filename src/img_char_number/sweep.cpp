@@ -0,0 +1,261 @@
+#include "neuron_sim.h"
+#include "img_char_number.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+namespace fs = std::filesystem;
+
+// 参数扫描：对多组模拟参数并发地训练+评估，每个任务在独立子进程中运行，
+// 调度时按各任务的估计内存占用装箱，不超过核数和内存上限。
+//
+// 用法: sweep [-j 并发数] [--mem-mb 内存上限] [--images 每个数字的训练图片数]
+//             [--eval 每个数字的测试图片数] [--out 结果文件] 名称=值1,值2,...
+// 例如: sweep -j 8 --images 5 threshold=150,250 chance=0.03,0.05 steps=200,1000
+
+// 子进程通过管道回传的结果
+struct JobResult {
+    double accuracy;
+    double trainSeconds;
+    double evalSeconds;
+    long long modelBytes;
+    long long synapses;
+};
+
+struct SweepJob {
+    SimulationParams params;
+    JobResult result;
+    long peakRssKB;
+    bool done;
+};
+
+struct RunningJob {
+    pid_t pid;
+    int fd;
+    size_t job;
+    long reservedKB;
+};
+
+// 在子进程中运行一个任务：训练、保存模型（统计大小）、按 recognize 的方式逐张识别
+static JobResult run_job(const SimulationParams& params,
+                         const std::vector<DigitImage>& trainSet,
+                         const std::vector<DigitImage>& evalSet) {
+    JobResult result{};
+    NeuralNetworkSimulation sim(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, params);
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& sample : trainSet) {
+        train_on_image(sim, sample.img, sample.digit);
+    }
+    auto trained = std::chrono::steady_clock::now();
+    result.trainSeconds = std::chrono::duration<double>(trained - start).count();
+    result.synapses = sim.getTotalSynapses();
+
+    std::string modelPath = (fs::temp_directory_path() / ("neuron_sweep_" + std::to_string(getpid()) + ".bin")).string();
+    NeuralNetworkSimulation model(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, params);
+    if (save_training_result(sim, modelPath) && load_training_result(model, modelPath)) {
+        result.modelBytes = fs::file_size(modelPath);
+    }
+    fs::remove(modelPath);
+
+    int correct = 0;
+    auto evalStart = std::chrono::steady_clock::now();
+    for (const auto& sample : evalSet) {
+        NeuralNetworkSimulation copy = model;
+        if (recognize_digit(copy, sample.img) == sample.digit) correct++;
+    }
+    auto evalEnd = std::chrono::steady_clock::now();
+    result.evalSeconds = std::chrono::duration<double>(evalEnd - evalStart).count();
+    result.accuracy = evalSet.empty() ? 0.0 : static_cast<double>(correct) / evalSet.size();
+    return result;
+}
+
+// 读取 /proc/meminfo 中的可用内存（KB）
+static long available_memory_kb() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    long value;
+    std::string unit;
+    while (meminfo >> key >> value >> unit) {
+        if (key == "MemAvailable:") return value;
+    }
+    return 4L * 1024 * 1024;
+}
+
+// 把 "threshold=150,250" 这样的规格展开成笛卡尔积
+static bool expand_grid(const std::vector<std::string>& specs, std::vector<SimulationParams>& grid) {
+    SimulationParams base;
+    base.connectionThreshold = DIGIT_THRESHOLD;
+    grid.assign(1, base);
+    for (const auto& spec : specs) {
+        size_t eq = spec.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = spec.substr(0, eq);
+        std::vector<SimulationParams> expanded;
+        std::stringstream values(spec.substr(eq + 1));
+        std::string value;
+        while (std::getline(values, value, ',')) {
+            for (auto params : grid) {
+                if (!parse_simulation_param(params, name + "=" + value)) return false;
+                expanded.push_back(params);
+            }
+        }
+        grid = std::move(expanded);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int maxJobs = std::max(1u, std::thread::hardware_concurrency());
+    long memBudgetKB = available_memory_kb() * 8 / 10;
+    size_t trainPerDigit = 3;
+    size_t evalPerDigit = 0;
+    std::string outPath = "sweep_results.tsv";
+    std::vector<std::string> specs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) maxJobs = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--mem-mb" && i + 1 < argc) memBudgetKB = std::stol(argv[++i]) * 1024;
+        else if (arg == "--images" && i + 1 < argc) trainPerDigit = std::stoul(argv[++i]);
+        else if (arg == "--eval" && i + 1 < argc) evalPerDigit = std::stoul(argv[++i]);
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else specs.push_back(arg);
+    }
+    if (evalPerDigit == 0) evalPerDigit = trainPerDigit;
+
+    std::vector<SimulationParams> grid;
+    if (!expand_grid(specs, grid)) {
+        std::cerr << "用法: " << argv[0] << " [-j 并发数] [--mem-mb 内存上限] [--images N] [--eval N] [--out 文件]"
+                  << " threshold=... chance=... lr=... decay=... steps=..." << std::endl;
+        return 1;
+    }
+
+    // 在父进程中一次性解码图片，子进程通过写时复制共享
+    std::vector<DigitSample> trainFiles, holdoutFiles;
+    split_digit_samples(list_digit_samples(DIGIT_TRAIN_DIR), trainFiles, holdoutFiles);
+    std::vector<DigitImage> trainSet = load_digit_images(trainFiles, trainPerDigit);
+    std::vector<DigitImage> evalSet = load_digit_images(holdoutFiles, evalPerDigit);
+    if (trainSet.empty() || evalSet.empty()) {
+        std::cerr << "训练集或测试集为空: " << DIGIT_TRAIN_DIR << std::endl;
+        return 1;
+    }
+
+    std::cout << "参数组合: " << grid.size() << "  并发: " << maxJobs
+              << "  内存上限: " << memBudgetKB / 1024 << " MB"
+              << "  训练/测试图片: " << trainSet.size() << "/" << evalSet.size() << std::endl;
+
+    std::vector<SweepJob> jobs;
+    for (const auto& params : grid) jobs.push_back({params, {}, 0, false});
+
+    // 内存估计：同一连接阈值下已完成任务的最大峰值RSS（阈值决定突触数量），
+    // 没有数据时用所有任务的最大值，仍没有时用保守的默认值
+    const long DEFAULT_ESTIMATE_KB = 64 * 1024;
+    std::map<double, long> peakByThreshold;
+    long peakOverall = 0;
+    auto estimate = [&](const SweepJob& job) {
+        auto it = peakByThreshold.find(job.params.connectionThreshold);
+        long kb = it != peakByThreshold.end() ? it->second : (peakOverall > 0 ? peakOverall : DEFAULT_ESTIMATE_KB);
+        return kb + kb / 5;
+    };
+
+    std::deque<size_t> pending;
+    for (size_t i = 0; i < jobs.size(); ++i) pending.push_back(i);
+    std::vector<RunningJob> running;
+    long reservedKB = 0;
+    size_t finished = 0;
+
+    while (finished < jobs.size()) {
+        // 首次适配：依次尝试每个等待中的任务，放得下就启动
+        for (auto it = pending.begin(); it != pending.end() && static_cast<int>(running.size()) < maxJobs;) {
+            long need = estimate(jobs[*it]);
+            if (!running.empty() && reservedKB + need > memBudgetKB) {
+                ++it;
+                continue;
+            }
+            int fds[2];
+            if (pipe(fds) != 0) {
+                std::cerr << "无法创建管道" << std::endl;
+                return 1;
+            }
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(fds[0]);
+                JobResult result = run_job(jobs[*it].params, trainSet, evalSet);
+                ssize_t written = write(fds[1], &result, sizeof(result));
+                _exit(written == sizeof(result) ? 0 : 1);
+            }
+            close(fds[1]);
+            if (pid < 0) {
+                close(fds[0]);
+                std::cerr << "无法创建子进程" << std::endl;
+                return 1;
+            }
+            running.push_back({pid, fds[0], *it, need});
+            reservedKB += need;
+            it = pending.erase(it);
+        }
+
+        int status = 0;
+        struct rusage usage;
+        pid_t pid = wait4(-1, &status, 0, &usage);
+        if (pid < 0) break;
+        auto it = std::find_if(running.begin(), running.end(), [pid](const RunningJob& r) { return r.pid == pid; });
+        if (it == running.end()) continue;
+
+        SweepJob& job = jobs[it->job];
+        job.peakRssKB = usage.ru_maxrss;
+        job.done = WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+                   read(it->fd, &job.result, sizeof(job.result)) == sizeof(job.result);
+        close(it->fd);
+        reservedKB -= it->reservedKB;
+        peakByThreshold[job.params.connectionThreshold] =
+            std::max(peakByThreshold[job.params.connectionThreshold], job.peakRssKB);
+        peakOverall = std::max(peakOverall, job.peakRssKB);
+        running.erase(it);
+        finished++;
+
+        std::cout << "[" << finished << "/" << jobs.size() << "] "
+                  << (job.done ? "完成" : "失败") << "  threshold=" << job.params.connectionThreshold
+                  << " chance=" << job.params.activationChance << " lr=" << job.params.learningRate
+                  << " decay=" << job.params.decayRate << " steps=" << job.params.trainSteps << std::endl;
+    }
+
+    // 结果表按准确率降序、训练耗时升序排列
+    std::vector<const SweepJob*> sorted;
+    for (const auto& job : jobs) sorted.push_back(&job);
+    std::sort(sorted.begin(), sorted.end(), [](const SweepJob* a, const SweepJob* b) {
+        if (a->done != b->done) return a->done;
+        if (a->result.accuracy != b->result.accuracy) return a->result.accuracy > b->result.accuracy;
+        return a->result.trainSeconds < b->result.trainSeconds;
+    });
+
+    std::ofstream out(outPath);
+    std::ostringstream table;
+    table << "threshold\tchance\tlr\tdecay\tsteps\taccuracy\ttrain_s\teval_s\tmodel_bytes\tsynapses\tpeak_rss_mb\tstatus\n";
+    for (const SweepJob* job : sorted) {
+        table << job->params.connectionThreshold << '\t' << job->params.activationChance << '\t'
+              << job->params.learningRate << '\t' << job->params.decayRate << '\t' << job->params.trainSteps << '\t'
+              << std::fixed << std::setprecision(4) << job->result.accuracy << '\t'
+              << std::setprecision(2) << job->result.trainSeconds << '\t' << job->result.evalSeconds << '\t'
+              << job->result.modelBytes << '\t' << job->result.synapses << '\t'
+              << std::setprecision(1) << job->peakRssKB / 1024.0 << '\t' << (job->done ? "ok" : "failed") << '\n';
+        table.unsetf(std::ios::fixed);
+        table << std::setprecision(6);
+    }
+    out << table.str();
+    std::cout << std::endl << table.str() << std::endl << "结果已写入: " << outPath << std::endl;
+    return 0;
+}
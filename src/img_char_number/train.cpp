@@ -1,144 +1,210 @@
 #include "neuron_sim.h"
 #include "visualization.h"
-#include <fstream>
+#include "img_char_number.h"
+#include "frame_export.h"
+#include "event_trace.h"
+#include "glyph_generator.h"
 #include <iostream>
+#include <iomanip>
 #include <string>
 #include <vector>
+#include <memory>
+#include <chrono>
 #include <filesystem>
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include <random>
 
 namespace fs = std::filesystem;
 
-// 加载PNG图片并转换为灰度值（0-1）
-std::vector<std::vector<double>> load_png_image(const std::string& path, int target_width, int target_height) {
-    std::vector<std::vector<double>> img;
-    int width, height, channels;
-    
-    // 加载图片（自动转换为灰度图）
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 1);
-    if (!data) {
-        std::cerr << "无法加载图片: " << path << " (" << stbi_failure_reason() << ")" << std::endl;
-        return img;
-    }
-    
-    // 缩放图片到目标尺寸（最近邻缩放）
-    img.resize(target_height, std::vector<double>(target_width, 0.0));
-    double x_ratio = static_cast<double>(width) / target_width;
-    double y_ratio = static_cast<double>(height) / target_height;
-    
-    for (int y = 0; y < target_height; ++y) {
-        for (int x = 0; x < target_width; ++x) {
-            int src_x = static_cast<int>(x * x_ratio);
-            int src_y = static_cast<int>(y * y_ratio);
-            int idx = src_y * width + src_x;
-            // 反转颜色（假设黑色背景白色数字）
-            img[y][x] = 1.0 - (static_cast<double>(data[idx]) / 255.0);
+int main(int argc, char* argv[]) {
+    // 模拟参数可通过命令行覆盖，例如: train threshold=200 chance=0.03 lr=0.08 decay=0.01 steps=500
+    // 录制训练过程: --record 目录（PNG序列）或 --record-raw 文件/命名管道（原始BGRA帧），--every 每隔多少步录一帧
+    // 记录发放和突触事件: --trace 文件（用 trace_reader 查看）
+    // 数据并行训练: --replicas K 个副本，--merge-every 每个副本训练多少张图片后合并一次，--merge avg|max
+    // 合成样本训练: --synthetic N 张由字体直接生成并随机增强的样本（不读训练目录），--fonts 字体目录（默认系统字体目录）
+    // 默认只用训练目录中 split_digit_samples 的训练集，留出集留给 evaluate；--all-images 使用全部图片
+    SimulationParams params;
+    params.connectionThreshold = DIGIT_THRESHOLD;
+    std::string recordPath;
+    FrameOutput recordOutput = FrameOutput::PNG_SEQUENCE;
+    int recordEvery = 10;
+    std::string tracePath;
+    int replicas = 1;
+    int mergeEvery = 1;
+    SynapseMergeMode mergeMode = SynapseMergeMode::AVERAGE;
+    size_t syntheticCount = 0;
+    std::string fontDir;
+    bool allImages = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+            recordOutput = FrameOutput::PNG_SEQUENCE;
+        } else if (arg == "--record-raw" && i + 1 < argc) {
+            recordPath = argv[++i];
+            recordOutput = FrameOutput::RAW_STREAM;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--replicas" && i + 1 < argc) {
+            replicas = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--merge-every" && i + 1 < argc) {
+            mergeEvery = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--merge" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode != "avg" && mode != "max") {
+                std::cerr << "--merge 只能是 avg 或 max" << std::endl;
+                return 1;
+            }
+            mergeMode = mode == "max" ? SynapseMergeMode::MAX : SynapseMergeMode::AVERAGE;
+        } else if (arg == "--synthetic" && i + 1 < argc) {
+            syntheticCount = std::stoul(argv[++i]);
+        } else if (arg == "--fonts" && i + 1 < argc) {
+            fontDir = argv[++i];
+        } else if (arg == "--all-images") {
+            allImages = true;
+        } else if (arg == "--every" && i + 1 < argc) {
+            recordEvery = std::max(1, std::stoi(argv[++i]));
+        } else if (!parse_simulation_param(params, arg)) {
+            std::cerr << "无法识别的参数: " << argv[i]
+                      << "（可用: threshold= chance= lr= decay= steps= seed= --record --record-raw --every --trace --replicas --merge-every --merge --synthetic --fonts --all-images）" << std::endl;
+            return 1;
         }
     }
     
-    stbi_image_free(data);
-    return img;
-}
+    // 创建神经网络模拟
+    NeuralNetworkSimulation simulation(DIGIT_NUM_NEURONS, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT, params);
+    std::cout << "初始化神经网络，神经元数量: " << DIGIT_NUM_NEURONS << std::endl;
 
-// 保存训练结果
-void save_training_result(const NeuralNetworkSimulation& sim, const std::string& path) {
-    std::ofstream file(path, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "无法打开文件保存训练结果: " << path << std::endl;
+    std::unique_ptr<FrameExporter> recorder;
+    std::function<void(const NeuralNetworkSimulation&)> afterStep;
+    if (!recordPath.empty()) {
+        recorder = std::make_unique<FrameExporter>(recordOutput, recordPath, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT,
+                                                   recordEvery);
+        if (!recorder->start()) return 1;
+        afterStep = [&recorder](const NeuralNetworkSimulation& sim) { recorder->onStep(sim); };
+        std::cout << "录制到: " << recordPath << "（每 " << recordEvery << " 步一帧，"
+                  << DIGIT_SIM_WIDTH << "x" << DIGIT_SIM_HEIGHT << "）" << std::endl;
     }
-    
-    // 保存神经元数量
-    size_t num_neurons = sim.neurons.size();
-    file.write(reinterpret_cast<const char*>(&num_neurons), sizeof(num_neurons));
-    
-    // 保存每个神经元的连接信息
-    for (const auto& neuron : sim.neurons) {
-        const auto& synapses = neuron.getActiveSynapses();
-        size_t num_synapses = synapses.size();
-        file.write(reinterpret_cast<const char*>(&num_synapses), sizeof(num_synapses));
-        
-        for (const auto& synapse : synapses) {
-            file.write(reinterpret_cast<const char*>(&synapse.targetNeuron), sizeof(synapse.targetNeuron));
-            file.write(reinterpret_cast<const char*>(&synapse.strength), sizeof(synapse.strength));
-            file.write(reinterpret_cast<const char*>(&synapse.lastUsed), sizeof(synapse.lastUsed));
+    std::unique_ptr<TraceRecorder> tracer;
+    if (!tracePath.empty()) {
+        tracer = std::make_unique<TraceRecorder>(tracePath);
+        if (!tracer->start()) return 1;
+        simulation.trace = tracer.get();
+    }
+    auto trainStart = std::chrono::steady_clock::now();
+
+    // 训练目录中参与训练的图片：默认为训练集，--all-images 时包括留出集
+    TrainingData trainingData = allImages ? TrainingData::ALL_IMAGES : TrainingData::TRAIN_SPLIT;
+    std::vector<DigitSample> trainFiles;
+    if (syntheticCount == 0) {
+        std::vector<DigitSample> all = list_digit_samples(DIGIT_TRAIN_DIR), holdout;
+        if (allImages) {
+            trainFiles = std::move(all);
+        } else {
+            split_digit_samples(all, trainFiles, holdout);
+            std::cout << "训练集: " << trainFiles.size() << " 张（留出 " << holdout.size()
+                      << " 张用于 evaluate，--all-images 使用全部图片）" << std::endl;
         }
     }
-    
-    std::cout << "训练结果已保存到: " << path << std::endl;
-}
 
-int main() {
-    const int SIM_WIDTH = 1000;
-    const int SIM_HEIGHT = 800;
-    const int INPUT_WIDTH = 28;   // MNIST格式大小
-    const int INPUT_HEIGHT = 28;
-    const int NUM_NEURONS = INPUT_WIDTH * INPUT_HEIGHT + 10;  // 输入层 + 10个输出神经元
-    const double THRESHOLD = 250;
-    const int TRAIN_STEPS = 1000;
-    
-    // 创建神经网络模拟
-    NeuralNetworkSimulation simulation(NUM_NEURONS, SIM_WIDTH, SIM_HEIGHT, THRESHOLD);
-    std::cout << "初始化神经网络，神经元数量: " << NUM_NEURONS << std::endl;
+    if (syntheticCount > 0) {
+        trainingData = TrainingData::SYNTHETIC;
+        std::vector<std::string> fonts = fontDir.empty() ? list_font_files() : list_font_files({fontDir});
+        GlyphGenerator generator(fonts, params.seed ? params.seed : std::random_device{}());
+        if (generator.getFontCount() == 0) {
+            std::cerr << "没有可用的字体（" << (fontDir.empty() ? "系统字体目录" : fontDir) << "）" << std::endl;
+            return 1;
+        }
+        std::cout << "合成样本训练: " << syntheticCount << " 张，字体 " << generator.getFontCount() << " 个" << std::endl;
 
-    // 训练0-9数字
-    for (int digit = 0; digit < 10; ++digit) {
-        std::cout << "训练数字: " << digit << std::endl;
-        std::string img_dir = "./train/img/char/number/" + std::to_string(digit);
-        
-        if (!fs::exists(img_dir)) {
-            std::cerr << "训练目录不存在: " << img_dir << std::endl;
-            continue;
+        // 样本按数字轮流生成；数据并行时先全部生成到内存，否则边生成边训练
+        double generateSeconds = 0;
+        auto timed_generate = [&](int digit, std::vector<std::vector<double>>& img) {
+            auto start = std::chrono::steady_clock::now();
+            generator.generate(digit, img);
+            generateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        };
+        if (replicas > 1) {
+            std::vector<DigitImage> images(syntheticCount);
+            for (size_t i = 0; i < syntheticCount; ++i) {
+                images[i].digit = static_cast<int>(i % DIGIT_COUNT);
+                timed_generate(images[i].digit, images[i].img);
+            }
+            train_data_parallel(simulation, images, replicas, mergeEvery, mergeMode, true, afterStep);
+        } else {
+            std::vector<std::vector<double>> img;
+            for (size_t i = 0; i < syntheticCount; ++i) {
+                int digit = static_cast<int>(i % DIGIT_COUNT);
+                timed_generate(digit, img);
+                train_on_image(simulation, img, digit, true, afterStep);
+            }
         }
+        std::cout << "样本生成: " << std::fixed << std::setprecision(0) << syntheticCount / std::max(1e-9, generateSeconds)
+                  << " 张/秒（共 " << std::setprecision(3) << generateSeconds << " 秒）" << std::endl;
+    } else if (replicas > 1) {
+        // 所有图片先解码到内存，再按轮转方式分给各副本
+        std::vector<DigitImage> images = load_digit_images(trainFiles);
+        std::cout << "数据并行训练: " << replicas << " 个副本，图片 " << images.size()
+                  << "，每个副本每 " << mergeEvery << " 张合并一次（"
+                  << (mergeMode == SynapseMergeMode::MAX ? "max" : "avg") << "）" << std::endl;
+        train_data_parallel(simulation, images, replicas, mergeEvery, mergeMode, true, afterStep);
+    } else {
+        // 训练0-9数字（trainFiles 按数字排列）
+        size_t next = 0;
+        for (int digit = 0; digit < DIGIT_COUNT; ++digit) {
+            std::cout << "训练数字: " << digit << std::endl;
+            std::string img_dir = std::string(DIGIT_TRAIN_DIR) + "/" + std::to_string(digit);
         
-        // 加载该数字的所有PNG图片
-        int img_count = 0;
-        for (const auto& entry : fs::directory_iterator(img_dir)) {
-            if (entry.path().extension() == ".png") {
-                auto img = load_png_image(entry.path(), INPUT_WIDTH, INPUT_HEIGHT);
+            if (!fs::exists(img_dir)) {
+                std::cerr << "训练目录不存在: " << img_dir << std::endl;
+                continue;
+            }
+        
+            // 加载该数字的所有PNG图片
+            int img_count = 0;
+            for (; next < trainFiles.size() && trainFiles[next].digit == digit; ++next) {
+                auto img = load_png_image(trainFiles[next].path, DIGIT_INPUT_WIDTH, DIGIT_INPUT_HEIGHT);
                 if (img.empty()) {
-                    std::cerr << "无效的图片: " << entry.path() << std::endl;
+                    std::cerr << "无效的图片: " << trainFiles[next].path << std::endl;
                     continue;
                 }
-                
+            
                 img_count++;
-                // 激活输入层神经元（前28*28个神经元）
-                for (int y = 0; y < INPUT_HEIGHT; ++y) {
-                    for (int x = 0; x < INPUT_WIDTH; ++x) {
-                        int neuron_idx = y * INPUT_WIDTH + x;
-                        if (img[y][x] > 0.5 && neuron_idx < simulation.neurons.size()) {
-                            simulation.neurons[neuron_idx].fire(simulation.currentStep);
-                        }
-                    }
-                }
-                
-                // 激活对应数字的输出神经元（最后10个神经元）
-                int output_neuron = INPUT_WIDTH * INPUT_HEIGHT + digit;
-                if (output_neuron < simulation.neurons.size()) {
-                    simulation.neurons[output_neuron].fire(simulation.currentStep);
-                }
-                
-                // 运行训练步骤
-                for (int step = 0; step < TRAIN_STEPS; ++step) {
-                    simulation.step();
-                    if (step % 100 == 0) {
-                        std::cout << "\r训练进度: " << (step * 100 / TRAIN_STEPS) << "% " << std::flush;
-                    }
-                }
-                std::cout << "\r训练进度: 100% 完成" << std::endl;
+                train_on_image(simulation, img, digit, true, afterStep);
             }
-        }
         
-        std::cout << "数字 " << digit << " 训练完成，处理图片数量: " << img_count << std::endl;
+            std::cout << "数字 " << digit << " 训练完成，处理图片数量: " << img_count << std::endl;
+        }
     }
     
+    double trainSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - trainStart).count();
+    std::cout << "训练耗时: " << std::fixed << std::setprecision(2) << trainSeconds << " 秒" << std::endl;
+    if (recorder) {
+        // 训练线程上的直接开销是复制快照，渲染和编码在后台线程；没有空闲CPU核时，
+        // 后台线程还会与训练分时运行，这部分只体现在训练耗时里
+        recorder->finish();
+        FrameExportStats stats = recorder->getStats();
+        std::cout << "录制帧数: " << stats.written << "  丢弃: " << stats.dropped
+                  << "  训练线程复制快照: " << stats.captureMs / 1000.0 << " 秒（"
+                  << 100.0 * stats.captureMs / 1000.0 / trainSeconds << "%，单次最长 " << stats.maxStallMs << " 毫秒）"
+                  << "  后台渲染+编码: " << stats.encodeMs / std::max(1L, stats.captured) << " 毫秒/帧" << std::endl;
+    }
+
+    if (tracer) {
+        simulation.trace = nullptr;
+        tracer->stop();
+        std::cout << "追踪事件: " << tracer->getWritten() << "  丢弃: " << tracer->getDropped()
+                  << "  文件大小: " << tracer->getBytes() << " 字节 -> " << tracePath << std::endl;
+    }
+
     // 保存训练结果
-    save_training_result(simulation, "./train/result/img_char_number.bin");
+    if (save_training_result(simulation, DIGIT_MODEL_PATH, trainingData)) {
+        std::cout << "训练结果已保存到: " << DIGIT_MODEL_PATH << std::endl;
+    }
 
     // // 可视化训练后的网络
     // std::cout << "显示训练后的神经网络..." << std::endl;
     // gtk_init(nullptr, nullptr);
-    // NeuronVisualization visualization(&simulation, SIM_WIDTH, SIM_HEIGHT);
+    // NeuronVisualization visualization(&simulation, DIGIT_SIM_WIDTH, DIGIT_SIM_HEIGHT);
     // visualization.run();
     
     return 0;
@@ -0,0 +1,112 @@
+#include "event_trace.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+
+// 读取 event_trace 写出的追踪文件
+// 用法: trace_reader 追踪文件            输出统计摘要
+//       trace_reader 追踪文件 --csv [输出文件]   转换为CSV（不指定输出文件时写到标准输出）
+
+static bool write_csv(TraceReader& reader, std::ostream& out) {
+    std::vector<TraceEvent> events;
+    out << "step,type,neuron,target,value\n";
+    while (reader.nextChunk(events)) {
+        for (const auto& e : events) {
+            out << e.step << ',' << trace_event_name(e.type) << ',' << e.neuron << ',' << e.target << ','
+                << e.value << '\n';
+        }
+    }
+    return !reader.failed();
+}
+
+static bool print_summary(TraceReader& reader, const std::string& path) {
+    std::vector<TraceEvent> events;
+    uint64_t total = 0, chunks = 0;
+    uint64_t byType[TRACE_EVENT_TYPES] = {};
+    uint32_t firstStep = UINT32_MAX, lastStep = 0;
+    std::map<int, uint64_t> firesByNeuron;
+    double strengthSum[TRACE_EVENT_TYPES] = {};
+
+    while (reader.nextChunk(events)) {
+        chunks++;
+        total += events.size();
+        for (const auto& e : events) {
+            int type = static_cast<int>(e.type);
+            if (type >= TRACE_EVENT_TYPES) continue;
+            byType[type]++;
+            strengthSum[type] += e.value;
+            firstStep = std::min(firstStep, e.step);
+            lastStep = std::max(lastStep, e.step);
+            if (e.type == TraceEventType::FIRE) firesByNeuron[e.neuron]++;
+        }
+    }
+    // 文件被截断时仍输出已完整读取的块的统计
+    auto fileBytes = std::filesystem::file_size(path);
+    uint64_t steps = total > 0 ? lastStep - firstStep + 1 : 0;
+    std::cout << "文件: " << path << "  " << fileBytes << " 字节  " << chunks << " 个块" << std::endl;
+    std::cout << "事件数: " << total << "  平均 " << std::fixed << std::setprecision(2)
+              << (total > 0 ? static_cast<double>(fileBytes) / total : 0.0) << " 字节/事件" << std::endl;
+    if (total == 0) return !reader.failed();
+    std::cout << "步数范围: " << firstStep << " - " << lastStep << "（" << steps << " 步）" << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(14) << "类型" << std::right << std::setw(12) << "数量"
+              << std::setw(12) << "每步" << std::setw(12) << "平均值" << std::endl;
+    for (int t = 0; t < TRACE_EVENT_TYPES; ++t) {
+        std::cout << std::left << std::setw(14) << trace_event_name(static_cast<TraceEventType>(t)) << std::right
+                  << std::setw(12) << byType[t]
+                  << std::setw(12) << std::setprecision(2) << static_cast<double>(byType[t]) / steps
+                  << std::setw(12) << std::setprecision(4) << (byType[t] ? strengthSum[t] / byType[t] : 0.0)
+                  << std::endl;
+    }
+    std::cout << "突触净增加: "
+              << static_cast<int64_t>(byType[static_cast<int>(TraceEventType::SYNAPSE_CREATE)]) -
+                 static_cast<int64_t>(byType[static_cast<int>(TraceEventType::SYNAPSE_DEACTIVATE)])
+              << std::endl;
+
+    // 发放次数最多的神经元
+    std::vector<std::pair<uint64_t, int>> ranked;
+    for (const auto& [neuron, count] : firesByNeuron) ranked.push_back({count, neuron});
+    std::sort(ranked.rbegin(), ranked.rend());
+    std::cout << std::endl << "发放最多的神经元（ID: 次数）:" << std::endl;
+    for (size_t i = 0; i < std::min<size_t>(10, ranked.size()); ++i) {
+        std::cout << "  " << ranked[i].second << ": " << ranked[i].first << std::endl;
+    }
+    std::cout << "发放过的神经元: " << firesByNeuron.size() << std::endl;
+    return !reader.failed();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: " << argv[0] << " 追踪文件 [--csv [输出文件]]" << std::endl;
+        return 1;
+    }
+    std::string path = argv[1];
+    TraceReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "无法读取追踪文件: " << path << std::endl;
+        return 1;
+    }
+
+    bool ok;
+    if (argc > 2 && std::string(argv[2]) == "--csv") {
+        if (argc > 3) {
+            std::ofstream out(argv[3]);
+            ok = write_csv(reader, out);
+        } else {
+            ok = write_csv(reader, std::cout);
+        }
+    } else {
+        ok = print_summary(reader, path);
+    }
+
+    if (!ok) {
+        std::cerr << "追踪文件损坏或被截断: " << path << std::endl;
+        return 1;
+    }
+    return 0;
+}